@@ -0,0 +1,198 @@
+/*************************************************************************************************************
+
+ Limelight Framework - SystemInfo Utils
+
+
+ Copyright 2016 mvd
+
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in
+ compliance with the License. You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software distributed under the License is
+ distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and limitations under the License.
+
+*************************************************************************************************************/
+
+#include "systeminfo/version.h"
+#include "systeminfo/platform.h"
+#include "systeminfo/process.h"
+
+#include <platform_utils/linux/shell_utils.h>
+#include <base/environment.h>
+
+LL_WARNING_DISABLE_GCC( deprecated-declarations )
+#include <boost/algorithm/string.hpp>
+#include <boost/tokenizer.hpp>
+LL_WARNING_ENABLE_GCC( deprecated-declarations )
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+using namespace ll::systeminfo;
+
+// -----------------------------------------------------------------------------------------------------------
+
+//! runs f_ repeatedly and returns the average duration of a single call in microseconds
+double measure( size_t iterations_, const std::function< void() >& f_ )
+{
+  f_();  // warm up, e.g. for lazily opened files
+
+  auto start = std::chrono::steady_clock::now();
+  for( size_t i = 0; i < iterations_; ++i )
+    f_();
+  auto stop = std::chrono::steady_clock::now();
+
+  return std::chrono::duration< double, std::micro >( stop - start ).count() 
+    / static_cast< double >( iterations_ );
+}
+
+
+void report( const std::string& name_, double before_, double after_ )
+{
+  std::cout << "  " << std::left << std::setw( 40 ) << name_ 
+            << std::right << std::fixed << std::setprecision( 2 )
+            << std::setw( 12 ) << before_ << " us" << std::setw( 12 ) << after_ << " us"
+            << std::setw( 10 ) << std::setprecision( 1 ) 
+            << ( after_ > 0.0 ? before_ / after_ : 0.0 ) << "x\n";
+}
+
+
+// -----------------------------------------------------------------------------------------------------------
+// Baselines: the way the library retrieved the information before switching to direct reads
+// -----------------------------------------------------------------------------------------------------------
+
+namespace legacy
+{
+  platform::memory_info get_memory_info()
+  {
+    std::map< std::string, std::string > rawInfo;
+
+    auto s = ll::utils::execute_shell_command( "cat /proc/meminfo" );
+    boost::char_separator< char > separator{ ":\n" };
+    boost::tokenizer< boost::char_separator<char> >  tokenizer{ s, separator };
+    for ( auto it = tokenizer.begin(); it != tokenizer.end(); ++it )
+    {
+      auto key = *it;
+      rawInfo[ key ] = boost::replace_all_copy( *(++it), "\"", "" );
+    }
+
+    platform::memory_info info;
+    info.totalPhysicalMemoryInBytes = std::stoll( boost::trim_copy( rawInfo[ "MemTotal" ] ) ) * 1024;
+    info.availablePhysicalMemoryInBytes = std::stoll( boost::trim_copy( rawInfo[ "MemFree" ] ) ) * 1024;
+    info.totalVirtualMemoryInBytes = std::stoll( boost::trim_copy( rawInfo[ "SwapTotal" ] ) ) * 1024;
+    info.totalVirtualMemoryInBytes += info.totalPhysicalMemoryInBytes;
+    info.availableVirtualMemoryInBytes = std::stoll( boost::trim_copy( rawInfo[ "SwapFree" ] ) ) * 1024;
+    info.availableVirtualMemoryInBytes += info.availablePhysicalMemoryInBytes;
+    return info;
+  }
+
+
+  void update_cpu_info( platform::cpu_info& info_ )
+  {
+    std::vector< unsigned > speed;
+
+    auto s = ll::utils::execute_shell_command( "export LANG=C;cat /proc/cpuinfo | grep \"cpu MHz\"" );
+    boost::char_separator< char > separator{ ":\n" };
+    boost::tokenizer< boost::char_separator<char> >  tokenizer{ s, separator };
+    for ( auto it = tokenizer.begin(); it != tokenizer.end(); ++it )
+      speed.push_back( std::stoi( *(++it) ) );
+
+    size_t index = 0;
+    for( auto& p : info_.processorPacks )
+      for( auto& c : p.physicalCores )
+        for( auto& l : c.logicalCores )
+          l.currentSpeedInMHz = ( index < speed.size() ) ? speed[ index++ ] : 0;
+  }
+
+}  // namespace legacy
+
+
+// -----------------------------------------------------------------------------------------------------------
+
+void benchmark_platform()
+{
+  std::cout << "Platform:\n---------\n\n";
+  std::cout << "  " << std::left << std::setw( 40 ) << "call" << std::right
+            << std::setw( 15 ) << "before" << std::setw( 15 ) << "after" << std::setw( 11 ) << "speedup\n";
+
+  auto before = measure( 200, []() { legacy::get_memory_info(); } );
+  auto after = measure( 200, []() { platform::get_memory_info(); } );
+  report( "get_memory_info()", before, after );
+
+  auto cpu = platform::get_cpu_info();
+  before = measure( 200, [&]() { legacy::update_cpu_info( cpu ); } );
+  after = measure( 200, [&]() { platform::update_cpu_info( cpu ); } );
+  report( "update_cpu_info()", before, after );
+
+  std::cout << "\n\n";
+}
+
+
+// -----------------------------------------------------------------------------------------------------------
+
+void benchmark_process()
+{
+  std::cout << "Process:\n--------\n\n";
+
+  // an idle thread pool of the size a 1 Hz sampler has to handle
+  std::mutex mutex;
+  std::condition_variable stopped;
+  bool stop = false;
+  std::vector< std::thread > threads;
+  for( size_t i = 0; i < 500; ++i )
+  {
+    threads.emplace_back( [&]() 
+    { 
+      std::unique_lock< std::mutex > lock( mutex );
+      stopped.wait( lock, [&stop]() { return stop; } ); 
+    } );
+  }
+
+  for( auto scan : { process::scan_context_switches::exclude, process::scan_context_switches::include } )
+  {
+    process::thread_sampler sampler( scan );
+    auto duration = measure( 50, [&]() { sampler.sample(); } );
+
+    auto name = std::string( "thread_sampler, 500 threads" ) 
+              + ( ( scan == process::scan_context_switches::include ) ? " + switches" : "" );
+    std::cout << "  " << std::left << std::setw( 40 ) << name << std::right << std::fixed 
+              << std::setprecision( 2 ) << std::setw( 27 ) << duration << " us\n";
+  }
+
+  {
+    std::lock_guard< std::mutex > lock( mutex );
+    stop = true;
+  }
+  stopped.notify_all();
+  for( auto& t : threads )
+    t.join();
+
+  std::cout << "\n\n";
+}
+
+
+// -----------------------------------------------------------------------------------------------------------
+
+int main()
+{
+  std::cout << "Limelight Framework - SystemInfo v" << ll::systeminfo::libraryVersionMajor << "."
+            << ll::systeminfo::libraryVersionMinor << "." << ll::systeminfo::libraryVersionMicro 
+            << " Benchmark\n\n";
+
+  benchmark_platform();
+  benchmark_process();
+
+  return 0;
+}
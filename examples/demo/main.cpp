@@ -17,14 +17,22 @@
 *************************************************************************************************************/
 
 #include "systeminfo/version.h"
+#include "systeminfo/counters.h"
+#include "systeminfo/cpu_features.h"
+#include "systeminfo/exception.h"
 #include "systeminfo/os.h"
 #include "systeminfo/platform.h"
+#include "systeminfo/process.h"
 #include "systeminfo/storage.h"
 
+#include <boost/filesystem/operations.hpp>
+
 #include <vector>
 #include <map>
 #include <iostream>
 #include <numeric>
+#include <chrono>
+#include <thread>
 
 
 using namespace ll::systeminfo;
@@ -46,6 +54,10 @@ void output_platform_info()
   std::cout << "Number of processor packs: " << cpus.processorPacks.size() << "\n";
   std::cout << "Total number of physical cores: " << get_physical_core_count( cpus ) << "\n";
   std::cout << "Total number of logical cores: " << get_logical_core_count( cpus ) << "\n";
+
+  auto budget = get_cpu_budget();
+  std::cout << "Usable processor budget: " << budget.logicalCores << " of " 
+            << budget.allowedLogicalCores.size() << " allowed logical cores\n";
   for( const auto& p : cpus.processorPacks )
   {
     auto logicalCoreCount = std::accumulate( 
@@ -80,14 +92,85 @@ void output_platform_info()
     std::cout << "\n\n";
   }
 
+  std::cout << "Instruction set extensions: " << ll::to_string( get_isa_features() ) << "\n\n";
+
+  cpu_times previousTimes, currentTimes;
+  cpu_load load;
+  get_cpu_times( previousTimes );
+  std::this_thread::sleep_for( std::chrono::milliseconds( 250 ) );
+  get_cpu_times( currentTimes );
+  get_cpu_load( previousTimes, currentTimes, load );
+
+  std::cout << "Total processor load: " << load.total.busyPercent << "%\n";
+  std::cout << "Processor load per logical core: ";
+  for( const auto& p : cpus.processorPacks )
+  {
+    for( const auto& c : p.physicalCores )
+    {
+      for( const auto& l : c.logicalCores )
+      {
+        if( l.id < load.logicalCores.size() )
+          std::cout << l.id << ": " << load.logicalCores[ l.id ].busyPercent << "%\t";
+      }
+    }
+  }
+  std::cout << "\n\n";
+
   auto memory = get_memory_info();
   std::cout << "Total physical memory in bytes: " << memory.totalPhysicalMemoryInBytes << "\n";
   std::cout << "Available physical memory in bytes: " << memory.availablePhysicalMemoryInBytes << "\n";
+  std::cout << "Free physical memory in bytes: " << memory.freePhysicalMemoryInBytes << "\n";
   std::cout << "Total virtual memory in bytes: " << memory.totalVirtualMemoryInBytes << "\n";
   std::cout << "Available virtual memory in bytes: " << memory.availableVirtualMemoryInBytes << "\n";
+  std::cout << "Effectively available memory in bytes: " << memory.effectiveAvailablePhysicalMemoryInBytes << "\n";
+  if( memory.cgroup.limitInBytes != unlimitedMemory )
+    std::cout << "cgroup memory limit in bytes: " << memory.cgroup.limitInBytes << "\n";
+  std::cout << "cgroup memory usage in bytes: " << memory.cgroup.usageInBytes << "\n";
+  std::cout << "\n";
+
+  auto hugepages = get_hugepage_info();
+  std::cout << "Page sizes in bytes: ";
+  for( auto size : get_page_sizes() )
+    std::cout << size << "\t";
+  std::cout << "\n";
+  for( const auto& p : hugepages.pools )
+    std::cout << "Huge pages of " << p.pageSizeInBytes << " bytes: " << p.freePages << " of " << p.totalPages << " free\n";
+  std::cout << "Transparent huge pages: " << ll::to_string( hugepages.transparentHugepages ) 
+            << " (defrag: " << ll::to_string( hugepages.transparentHugepageDefrag ) << ")\n";
+  std::cout << "\n";
+
+  try
+  {
+    for( auto r : { pressure_resource::cpu, pressure_resource::memory, pressure_resource::io } )
+    {
+      auto pressure = get_pressure_info( r );
+      std::cout << ll::to_string( r ) << " pressure (some / full, avg10): " 
+                << pressure.some.avg10 << "% / " << pressure.full.avg10 << "%\n";
+    }
+  }
+  catch( const ll::systeminfo::exception& e )
+  {
+    std::cout << e.what() << "\n";
+  }
   std::cout << "\n";
   
   
+  auto numa = get_numa_info();
+  std::cout << "Number of NUMA nodes: " << numa.nodes.size() << "\n";
+  for( const auto& n : numa.nodes )
+  {
+    std::cout << "NUMA node " << n.id << ": \n";
+    std::cout << "  Number of logical cores: " << n.logicalCores.size() << "\n";
+    std::cout << "  Total memory in bytes: " << n.totalMemoryInBytes << "\n";
+    std::cout << "  Free memory in bytes: " << n.freeMemoryInBytes << "\n";
+    std::cout << "  Distances: ";
+    for( auto d : n.distances )
+      std::cout << d << "\t";
+    std::cout << "\n";
+  }
+  std::cout << "\n";
+
+
   auto gpus = get_gpu_info();
   std::cout << "Number of GPUs: " << gpus.gpus.size() << "\n";
   for ( const auto& g : gpus.gpus )
@@ -159,9 +242,22 @@ void output_storage_info()
     { filesystem::hfs_plus, "MacOS Extended (HFS Plus)" },
     { filesystem::autofs, "Unknown (AutoFS)" },
     { filesystem::smb, "Samba" },
+    { filesystem::afp, "AFP" },
+    { filesystem::nfs, "NFS" },
     { filesystem::ext4, "ext4" },
+    { filesystem::xfs, "XFS" },
+    { filesystem::btrfs, "Btrfs" },
+    { filesystem::tmpfs, "tmpfs" },
+    { filesystem::overlay, "OverlayFS" },
+    { filesystem::zfs, "ZFS" },
+    { filesystem::nfs4, "NFSv4" },
   };
 
+  io_sampler io;
+  io.sample();
+  std::this_thread::sleep_for( std::chrono::milliseconds( 250 ) );
+  io.sample();
+
   std::cout << "Volumes:\n";
   auto info = get_storage_info();
   for( const auto&  v : info.volumes )
@@ -172,9 +268,104 @@ void output_storage_info()
     std::cout << "  Filesystem: " << filesystems[ v.fileSystem ] << "\n";
     std::cout << "  Total Size: " << v.totalSizeInBytes << " Bytes\n";
     std::cout << "  Available Size: " << v.availableSizeInBytes << " Bytes\n";
+    if( !v.device.name.empty() )
+    {
+      std::cout << "  Disk: " << v.device.name << " (" << ll::to_string( v.device.transport ) << ", block size " 
+                << v.device.logicalBlockSize << " / " << v.device.physicalBlockSize << ", scheduler " 
+                << v.device.scheduler << ")\n";
+    }
+    if( auto device = io.find( v ) )
+    {
+      std::cout << "  Device: " << device->name << " (" << device->readsPerSecond << " reads/s, " 
+                << device->writesPerSecond << " writes/s, " << device->utilizationPercent << "% busy)\n";
+    }
     std::cout << "\n";
   }
 
+  std::cout << "File systems:\n";
+  for( const auto& f : get_filesystems() )
+  {
+    std::cout << "  " << f.volume.path.string() << " (" << filesystems[ f.volume.fileSystem ] << "), " 
+              << f.mountPoints.size() << " mount point(s)\n";
+  }
+  std::cout << "\n";
+
+  try
+  {
+    auto directory = fs::temp_directory_path();
+    auto capabilities = get_io_capabilities( directory );
+    std::cout << "I/O capabilities of " << directory.string() << ":\n";
+    std::cout << "  Direct I/O: " << capabilities.directIo << " (alignment " 
+              << capabilities.directIoMemoryAlignment << " / " << capabilities.directIoOffsetAlignment << ")\n";
+    std::cout << "  Optimal block size: " << capabilities.optimalBlockSize << "\n";
+    std::cout << "  fallocate / punch hole: " << capabilities.fallocate << " / " << capabilities.punchHole << "\n";
+    std::cout << "  copy_file_range / reflink: " << capabilities.copyFileRange << " / " 
+              << capabilities.reflink << "\n";
+    std::cout << "  io_uring: " << capabilities.ioUring << "\n";
+  }
+  catch( const ll::systeminfo::exception& e )
+  {
+    std::cout << "I/O capabilities: " << e.what() << "\n";
+  }
+
+  std::cout << "\n\n";
+}
+
+
+// -----------------------------------------------------------------------------------------------------------
+
+void output_process_info()
+{
+  using namespace ll::systeminfo::process;
+
+  std::cout << "Process:\n--------\n\n";
+
+  auto previous = get_resource_usage( scan_proportional_set::include );
+  std::this_thread::sleep_for( std::chrono::milliseconds( 250 ) );
+  auto usage = previous;
+  update_resource_usage( usage, scan_proportional_set::include );
+  auto rates = get_resource_rates( previous, usage );
+
+  std::cout << "Resident set in bytes: " << usage.residentSetInBytes << "\n";
+  std::cout << "Peak resident set in bytes: " << usage.peakResidentSetInBytes << "\n";
+  std::cout << "Proportional set in bytes: " << usage.proportionalSetInBytes << "\n";
+  std::cout << "Page faults (minor / major): " << usage.minorPageFaults << " / " << usage.majorPageFaults << "\n";
+  std::cout << "Context switches (voluntary / involuntary): " << usage.voluntaryContextSwitches << " / " 
+            << usage.involuntaryContextSwitches << "\n";
+  std::cout << "Threads: " << usage.threadCount << "\n";
+  std::cout << "Open file descriptors: " << usage.openFileDescriptors << "\n";
+  std::cout << "CPU time (user / system): " << usage.userTime.count() << "us / " << usage.systemTime.count() << "us\n";
+  std::cout << "CPU usage (user / system): " << rates.userCpuPercent << "% / " << rates.systemCpuPercent << "%\n";
+
+  try
+  {
+    counter_group counters;
+    counter_values values;
+    {
+      counter_scope scope( counters, values );
+      std::vector< std::uint64_t > buffer( 1 << 20 );
+      std::iota( buffer.begin(), buffer.end(), 0 );
+    }
+
+    for( size_t i = 0; i < values.values.size(); ++i )
+    {
+      if( values.available.test( i ) )
+        std::cout << ll::to_string( static_cast< counter_event >( i ) ) << ": " << values.values[ i ] << "\n";
+    }
+    std::cout << "Instructions per cycle: " << values.instructions_per_cycle() << "\n";
+  }
+  catch( const ll::systeminfo::exception& e )
+  {
+    std::cout << e.what() << "\n";
+  }
+
+  thread_sampler sampler;
+  for( const auto& t : sampler.sample() )
+  {
+    std::cout << "Thread " << t.id << " (" << t.name << "): " << ll::to_string( t.state ) << ", cpu " 
+              << t.lastProcessor << ", " << t.userTime.count() << "us / " << t.systemTime.count() << "us\n";
+  }
+
   std::cout << "\n\n";
 }
 
@@ -188,6 +379,7 @@ int main()
     
   output_platform_info();
   output_os_info();
+  output_process_info();
   output_storage_info();
 
   return 0;
@@ -0,0 +1,138 @@
+/*************************************************************************************************************
+
+ Limelight Framework - SystemInfo Utils
+
+
+ Copyright 2016 mvd
+
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in
+ compliance with the License. You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software distributed under the License is
+ distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and limitations under the License.
+
+*************************************************************************************************************/
+
+#include "systeminfo/version.h"
+#include "systeminfo/disk_benchmark.h"
+#include "systeminfo/exception.h"
+#include "systeminfo/storage.h"
+
+#include <boost/filesystem/operations.hpp>
+
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+
+using namespace ll::systeminfo::storage;
+
+// -----------------------------------------------------------------------------------------------------------
+
+void usage()
+{
+  std::cout << "usage: ll_systeminfo_disk_benchmark [--duration <ms>] [--size <MiB>] [--no-io-uring] "
+            << "[<directory>...]\n\n"
+            << "  Runs the tests against a scratch file in each directory, or in the root of every local\n"
+            << "  volume if no directory is given.\n";
+}
+
+
+void output_report( const benchmark_report& report_ )
+{
+  const auto& v = report_.volume;
+  std::cout << "Volume: " << v.path.string() << " (" << v.name << ")\n";
+  std::cout << "  Device: " << v.device.name << " " << v.deviceMajor << ":" << v.deviceMinor << ", " 
+            << ll::to_string( v.device.transport ) << ", " << ll::to_string( v.type ) << "\n";
+  std::cout << "  Scratch file: " << report_.directory.string() << ", " << ( report_.fileSizeInBytes >> 20 ) 
+            << " MiB" << ( report_.directIo ? ", O_DIRECT" : ", buffered" ) << "\n\n";
+
+  std::cout << "  " << std::left << std::setw( 18 ) << "test" << std::setw( 10 ) << "engine" << std::right 
+            << std::setw( 8 ) << "block" << std::setw( 5 ) << "qd" << std::setw( 11 ) << "MiB/s" 
+            << std::setw( 11 ) << "IOPS" << std::setw( 10 ) << "p50 us" << std::setw( 10 ) << "p99 us" 
+            << std::setw( 10 ) << "p99.9 us" << std::setw( 10 ) << "max us" << "\n";
+
+  for( const auto& r : report_.results )
+  {
+    std::cout << "  " << std::left << std::setw( 18 ) << ll::to_string( r.pattern ) 
+              << std::setw( 10 ) << ll::to_string( r.engine ) << std::right 
+              << std::fixed << std::setprecision( 0 )
+              << std::setw( 8 ) << r.blockSize << std::setw( 5 ) << r.queueDepth 
+              << std::setw( 11 ) << r.bytes_per_second() / ( 1024.0 * 1024.0 ) 
+              << std::setw( 11 ) << r.operations_per_second() 
+              << std::setprecision( 1 ) 
+              << std::setw( 10 ) << r.latency.p50 << std::setw( 10 ) << r.latency.p99 
+              << std::setw( 10 ) << r.latency.p999 << std::setw( 10 ) << r.latency.maximum << "\n";
+  }
+
+  std::cout << "\n\n";
+}
+
+
+// -----------------------------------------------------------------------------------------------------------
+
+int main( int argc, char* argv[] )
+{
+  std::cout << "Limelight Framework - SystemInfo v" << ll::systeminfo::libraryVersionMajor << "."
+            << ll::systeminfo::libraryVersionMinor << "." << ll::systeminfo::libraryVersionMicro 
+            << " Disk Benchmark\n\n";
+
+  benchmark_options options;
+  std::vector< fs::path > directories;
+  for( int i = 1; i < argc; ++i )
+  {
+    if( ( std::strcmp( argv[ i ], "--duration" ) == 0 ) && ( i + 1 < argc ) )
+      options.duration = std::chrono::milliseconds( std::atoi( argv[ ++i ] ) );
+    else if( ( std::strcmp( argv[ i ], "--size" ) == 0 ) && ( i + 1 < argc ) )
+      options.fileSizeInBytes = std::strtoull( argv[ ++i ], nullptr, 10 ) << 20;
+    else if( std::strcmp( argv[ i ], "--no-io-uring" ) == 0 )
+      options.useIoUring = false;
+    else if( ( argv[ i ][ 0 ] == '-' ) || !fs::is_directory( argv[ i ] ) )
+    {
+      usage();
+      return 1;
+    }
+    else
+      directories.push_back( fs::canonical( argv[ i ] ) );
+  }
+
+  volume_resolver resolver( scan_network_storage::exclude );
+  std::vector< std::pair< storage_info::volume, fs::path > > targets;
+  if( directories.empty() )
+  {
+    for( const auto& v : resolver.info().volumes )
+    {
+      if( ( v.type != storage_type::network ) && ( v.type != storage_type::removable ) )
+        targets.emplace_back( v, v.path );
+    }
+  }
+
+  for( const auto& d : directories )
+  {
+    auto volume = resolver.resolve( d );
+    targets.emplace_back( volume ? *volume : storage_info::volume(), d );
+  }
+
+  int result = 0;
+  for( const auto& t : targets )
+  {
+    try
+    {
+      options.directory = t.second;
+      output_report( run_disk_benchmark( t.first, options ) );
+    }
+    catch( const ll::systeminfo::exception& e )
+    {
+      std::cout << t.second.string() << ": " << e.what() << "\n\n";
+      result = 1;
+    }
+  }
+
+  return result;
+}
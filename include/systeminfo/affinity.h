@@ -0,0 +1,78 @@
+/*************************************************************************************************************
+
+ Limelight Framework - SystemInfo Utils
+
+
+ Copyright 2016 mvd
+
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in
+ compliance with the License. You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software distributed under the License is
+ distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and limitations under the License.
+
+*************************************************************************************************************/
+
+#pragma once
+
+#include "systeminfo/platform.h"
+
+#include <thread>
+#include <vector>
+
+
+namespace ll
+{
+namespace systeminfo
+{
+namespace platform
+{
+  // ---------------------------------------------------------------------------------------------------------
+  // Types
+  // ---------------------------------------------------------------------------------------------------------
+
+  enum class affinity_policy
+  {
+    compact,               // use as few processor packs as possible, one thread per physical core first
+    spread,                // distribute the threads round robin across the processor packs
+    physical_cores_first,  // one thread per physical core on all packs before using smt siblings
+  };
+
+
+  struct affinity_options
+  {
+    affinity_policy policy = affinity_policy::physical_cores_first;
+
+    bool excludeIsolatedCores = true;       // see cpu_info::logical_core::isolated
+    std::vector< unsigned > excludedCores;  // e.g. housekeeping cores reserved for the os or for io threads
+  };
+
+
+  // ---------------------------------------------------------------------------------------------------------
+  // Functions
+  // ---------------------------------------------------------------------------------------------------------
+
+  //! returns one os processor id (cpu_info::logical_core::id) per thread, cores are reused if there are more
+  //! threads than usable cores
+  std::vector< unsigned > plan_thread_affinity( 
+    const cpu_info& cpu_, 
+    size_t threadCount_, 
+    const affinity_options& options_ = affinity_options() 
+  );
+
+
+  //! restricts a thread to the given processors, throws if the os refuses
+  void set_thread_affinity( std::thread::native_handle_type thread_, const std::vector< unsigned >& cpus_ );
+
+  void set_thread_affinity( std::thread& thread_, const std::vector< unsigned >& cpus_ );
+
+  void set_thread_affinity( std::thread& thread_, unsigned cpu_ );
+
+  void set_current_thread_affinity( const std::vector< unsigned >& cpus_ );
+
+}  // namespace platform
+}  // namespace systeminfo
+}  // namespace ll
@@ -0,0 +1,164 @@
+/*************************************************************************************************************
+
+ Limelight Framework - SystemInfo Utils
+
+
+ Copyright 2016 mvd
+
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in
+ compliance with the License. You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software distributed under the License is
+ distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and limitations under the License.
+
+*************************************************************************************************************/
+
+#pragma once
+
+#include <array>
+#include <bitset>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+namespace ll
+{
+namespace systeminfo
+{
+namespace process
+{
+  // ---------------------------------------------------------------------------------------------------------
+  // Types
+  // ---------------------------------------------------------------------------------------------------------
+
+  enum class counter_event
+  {
+    // hardware events, usually not available in virtual machines
+    cycles,
+    instructions,
+    cache_references,  // last level cache
+    cache_misses,
+    branches,
+    branch_misses,
+
+    // software events, counted by the kernel
+    task_clock,        // in nanoseconds
+    context_switches,
+    page_faults,
+
+    count  // not an event, the number of events
+  };
+
+
+  enum class counter_target
+  {
+    thread,   // the thread that creates the counter_group
+    process,  // every thread of the process, including the ones created afterwards (one group per thread)
+    cpu       // everything that runs on one logical core, usually requires elevated privileges
+  };
+
+
+  //! the counted events, scaled up if the kernel had to multiplex the hardware counters
+  struct counter_values
+  {
+    std::array< std::uint64_t, static_cast< size_t >( counter_event::count ) > values = { { 0 } };
+    std::bitset< static_cast< size_t >( counter_event::count ) > available;
+
+    std::chrono::nanoseconds timeEnabled{ 0 };
+    std::chrono::nanoseconds timeRunning{ 0 };  // less than timeEnabled if the counters were multiplexed
+
+    bool has( counter_event e_ ) const { return available.test( static_cast< size_t >( e_ ) ); }
+    std::uint64_t get( counter_event e_ ) const { return values[ static_cast< size_t >( e_ ) ]; }
+
+    //! 0 if one of the events isn't available
+    double instructions_per_cycle() const;
+    double cache_miss_ratio() const;
+    double branch_miss_ratio() const;
+  };
+
+
+  namespace impl
+  {
+    class counter_reader;
+  }
+
+  //! perf event groups that are read with a single system call each (linux only)
+  class counter_group
+  {
+  public:
+    //! falls back to the software events if the hardware events are not available, e.g. in a virtual machine
+    //! or due to kernel.perf_event_paranoid; throws invalid_request if not a single event can be opened
+    explicit counter_group( counter_target target_ = counter_target::thread, unsigned cpu_ = 0 );
+    counter_group( counter_target target_, unsigned cpu_, const std::vector< counter_event >& events_ );
+    ~counter_group();
+
+    //! a moved-from group counts nothing: enable, disable and reset do nothing and read returns no events
+    counter_group( counter_group&& other_ );
+    counter_group& operator=( counter_group&& other_ );
+
+    counter_group( const counter_group& ) = delete;
+    counter_group& operator=( const counter_group& ) = delete;
+
+    //! the group starts counting when it is created
+    void enable();
+    void disable();
+    void reset();
+
+    //! doesn't allocate, values_ can be reused
+    void read( counter_values& values_ ) const;
+    counter_values read() const;
+
+    //! the events that could be opened
+    const std::bitset< static_cast< size_t >( counter_event::count ) >& available() const;
+
+  private:
+    std::unique_ptr< impl::counter_reader > m_reader;
+  };
+
+
+  //! measures a code region: reads the group when it's created and stores the difference in its destructor
+  class counter_scope
+  {
+  public:
+    counter_scope( const counter_group& group_, counter_values& result_ );
+    ~counter_scope();
+
+    counter_scope( const counter_scope& ) = delete;
+    counter_scope& operator=( const counter_scope& ) = delete;
+
+  private:
+    const counter_group& m_group;
+    counter_values& m_result;
+    counter_values m_start;
+  };
+
+
+  // ---------------------------------------------------------------------------------------------------------
+  // Functions
+  // ---------------------------------------------------------------------------------------------------------
+
+  //! the events counted between two reads of the same group
+  counter_values get_counter_delta( const counter_values& previous_, const counter_values& current_ );
+
+}  // namespace process
+}  // namespace systeminfo
+}  // namespace ll
+
+
+
+// -----------------------------------------------------------------------------------------------------------
+// Utilities
+// -----------------------------------------------------------------------------------------------------------
+
+namespace ll
+{
+
+  std::string to_string( ll::systeminfo::process::counter_event e_ );
+
+}  // namespace ll
@@ -0,0 +1,212 @@
+/*************************************************************************************************************
+
+ Limelight Framework - SystemInfo Utils
+
+
+ Copyright 2016 mvd
+
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in
+ compliance with the License. You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software distributed under the License is
+ distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and limitations under the License.
+
+*************************************************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bitset>
+#include <initializer_list>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+namespace ll
+{
+namespace systeminfo
+{
+namespace platform
+{
+  // ---------------------------------------------------------------------------------------------------------
+  // Types
+  // ---------------------------------------------------------------------------------------------------------
+
+  enum class isa_feature
+  {
+    sse,
+    sse2,
+    sse3,
+    ssse3,
+    sse4_1,
+    sse4_2,
+    popcnt,
+    lzcnt,
+    movbe,
+    aes,
+    pclmulqdq,
+    rdrand,
+    rdseed,
+    adx,
+    sha,
+    bmi1,
+    bmi2,
+    f16c,
+    fma,
+    avx,
+    avx2,
+    avx_vnni,
+    vaes,
+    vpclmulqdq,
+    gfni,
+    avx512f,
+    avx512dq,
+    avx512cd,
+    avx512bw,
+    avx512vl,
+    avx512ifma,
+    avx512vbmi,
+    avx512vbmi2,
+    avx512vnni,
+    avx512bitalg,
+    avx512vpopcntdq,
+    avx512bf16,
+    avx512fp16,
+    amx_tile,
+    amx_int8,
+    amx_bf16,
+    count  // not a feature, the number of features
+  };
+
+
+  //! the instruction set extensions that are supported by the processor *and* enabled by the os
+  struct isa_features
+  {
+    std::string vendor;  // e.g. GenuineIntel, AuthenticAMD
+    std::bitset< static_cast< size_t >( isa_feature::count ) > features;
+
+    //! the processor and the os support amx, but the amx features are only reported after the process
+    //! called request_amx_permission() (linux)
+    bool amxPermissionRequired = false;
+
+    bool has( isa_feature f_ ) const { return features.test( static_cast< size_t >( f_ ) ); }
+
+    bool has_all( std::initializer_list< isa_feature > features_ ) const
+    {
+      return std::all_of( features_.begin(), features_.end(), [this]( isa_feature f_ ) { return has( f_ ); } );
+    }
+  };
+
+
+  //! selects the best of several implementations of a function once, based on the available isa features
+  template< typename function_t >
+  class dispatcher
+  {
+  public:
+    struct implementation
+    {
+      function_t function;
+      std::vector< isa_feature > requiredFeatures;
+      int priority;  // the usable implementation with the highest priority is selected
+    };
+
+    dispatcher() = default;
+    dispatcher( std::initializer_list< implementation > implementations_ ) : m_implementations( implementations_ ) {}
+
+    dispatcher( const dispatcher& ) = delete;
+    dispatcher& operator=( const dispatcher& ) = delete;
+
+    //! registers another implementation, this resets a previous selection
+    void add( function_t function_, std::initializer_list< isa_feature > requiredFeatures_, int priority_ )
+    {
+      std::lock_guard< std::mutex > lock( m_mutex );
+      m_implementations.push_back( implementation{ function_, requiredFeatures_, priority_ } );
+      m_selected.store( nullptr );
+    }
+
+    //! the selected implementation, nullptr if none of the registered implementations is usable
+    function_t get() const
+    {
+      auto f = m_selected.load( std::memory_order_acquire );
+      return f ? f : select();
+    }
+
+    operator function_t() const { return get(); }
+
+  private:
+    function_t select() const;
+
+    std::vector< implementation > m_implementations;
+    mutable std::atomic< function_t > m_selected{ nullptr };
+    mutable std::mutex m_mutex;
+  };
+
+
+  // ---------------------------------------------------------------------------------------------------------
+  // Functions
+  // ---------------------------------------------------------------------------------------------------------
+
+  //! determined with cpuid / xgetbv on first use and again after request_amx_permission(), empty on non-x86
+  //! architectures; doesn't change the process state
+  const isa_features& get_isa_features();
+
+  //! asks linux for the amx tile state of all threads of the process (arch_prctl ARCH_REQ_XCOMP_PERM),
+  //! get_isa_features() reports the amx features afterwards, dispatchers that already selected keep their
+  //! selection; false if amx isn't supported or the request is denied
+  bool request_amx_permission();
+
+  bool has_isa_feature( isa_feature f_ );
+
+
+  // ---------------------------------------------------------------------------------------------------------
+  // Implementation
+  // ---------------------------------------------------------------------------------------------------------
+
+  template< typename function_t >
+  function_t dispatcher< function_t >::select() const
+  {
+    std::lock_guard< std::mutex > lock( m_mutex );
+
+    const auto& features = get_isa_features();
+
+    const implementation* best = nullptr;
+    for( const auto& i : m_implementations )
+    {
+      bool usable = std::all_of(
+        i.requiredFeatures.begin(),
+        i.requiredFeatures.end(),
+        [&features]( isa_feature f_ ) { return features.has( f_ ); }
+      );
+
+      if( usable && ( !best || ( i.priority > best->priority ) ) )
+        best = &i;
+    }
+
+    auto f = best ? best->function : nullptr;
+    m_selected.store( f, std::memory_order_release );
+    return f;
+  }
+
+}  // namespace platform
+}  // namespace systeminfo
+}  // namespace ll
+
+
+
+// -----------------------------------------------------------------------------------------------------------
+// Utilities
+// -----------------------------------------------------------------------------------------------------------
+
+namespace ll
+{
+
+  std::string to_string( ll::systeminfo::platform::isa_feature f_ );
+
+  std::string to_string( const ll::systeminfo::platform::isa_features& f_ );
+
+}  // namespace ll
@@ -0,0 +1,134 @@
+/*************************************************************************************************************
+
+ Limelight Framework - SystemInfo Utils
+
+
+ Copyright 2016 mvd
+
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in
+ compliance with the License. You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software distributed under the License is
+ distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and limitations under the License.
+
+*************************************************************************************************************/
+
+#pragma once
+
+#include "systeminfo/storage.h"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+namespace ll
+{
+namespace systeminfo
+{
+namespace storage
+{
+  // ---------------------------------------------------------------------------------------------------------
+  // Types
+  // ---------------------------------------------------------------------------------------------------------
+
+  enum class benchmark_pattern
+  {
+    sequential_write,
+    sequential_read,
+    random_read
+  };
+
+
+  enum class benchmark_engine
+  {
+    sync,      // pread / pwrite, one thread per request in flight
+    io_uring   // one thread that keeps the requests in flight with a single ring (linux 5.1)
+  };
+
+
+  struct benchmark_options
+  {
+    fs::path directory;                            // where the scratch file is created, empty for the volume
+    std::uint64_t fileSizeInBytes = 512ull << 20;  // should be larger than the cache of the device
+    std::chrono::milliseconds duration{ 2000 };    // per test
+
+    unsigned sequentialBlockSize = 1 << 20;
+    unsigned sequentialQueueDepth = 4;
+    unsigned randomBlockSize = 4096;
+    std::vector< unsigned > randomQueueDepths = { 1, 8, 32 };
+
+    bool useIoUring = true;  // runs every test a second time with io_uring if it is available
+  };
+
+
+  struct benchmark_result
+  {
+    benchmark_pattern pattern = benchmark_pattern::sequential_write;
+    benchmark_engine engine = benchmark_engine::sync;
+    unsigned blockSize = 0;
+    unsigned queueDepth = 0;
+
+    std::uint64_t operations = 0;
+    std::uint64_t bytes = 0;
+    std::chrono::microseconds elapsed{ 0 };
+    latency_distribution latency;
+
+    double bytes_per_second() const;
+    double operations_per_second() const;
+  };
+
+
+  struct benchmark_report
+  {
+    storage_info::volume volume;  // identifies the volume together with volume.device
+    fs::path directory;
+    std::chrono::system_clock::time_point started;
+    std::uint64_t fileSizeInBytes = 0;
+    bool directIo = false;  // without O_DIRECT the results include the page cache
+
+    std::vector< benchmark_result > results;
+
+    //! nullptr if the test wasn't run
+    const benchmark_result* find( 
+      benchmark_pattern pattern_, 
+      benchmark_engine engine_, 
+      unsigned queueDepth_ 
+    ) const;
+  };
+
+
+  // ---------------------------------------------------------------------------------------------------------
+  // Functions
+  // ---------------------------------------------------------------------------------------------------------
+
+  //! runs the time bounded tests against a scratch file on the volume (linux only); the file is written
+  //! completely before the read tests, so the directory needs fileSizeInBytes of free space. Throws
+  //! invalid_parameter if the directory isn't writable and internal if a request fails
+  benchmark_report run_disk_benchmark( 
+    const storage_info::volume& volume_, 
+    const benchmark_options& options_ = benchmark_options() 
+  );
+
+}  // namespace storage
+}  // namespace systeminfo
+}  // namespace ll
+
+
+
+// -----------------------------------------------------------------------------------------------------------
+// Utilities
+// -----------------------------------------------------------------------------------------------------------
+
+namespace ll
+{
+
+  std::string to_string( ll::systeminfo::storage::benchmark_pattern p_ );
+
+  std::string to_string( ll::systeminfo::storage::benchmark_engine e_ );
+
+}  // namespace ll
@@ -18,9 +18,11 @@
 
 #pragma once
 
+#include <chrono>
 #include <string>
 #include <cstdint>
 #include <vector>
+#include <limits>
 #include <numeric>
 
 
@@ -42,38 +44,288 @@ namespace platform
     mobile
   };
 
+
+  enum class cache_type
+  {
+    unknown,
+    data,
+    instruction,
+    unified
+  };
+
   
   struct cpu_info
   {
     struct logical_core
     {
+      unsigned id = 0;  // the operating system's processor number, e.g. for setting thread affinities
+      unsigned numaNode = 0;  // index into numa_info::nodes
+      bool isolated = false;  // kept free of regular tasks by the kernel (isolcpus, nohz_full)
       unsigned currentSpeedInMHz = 0;
       unsigned maximumSpeedInMHz = 0;
+
+      std::vector< size_t > caches;  // indices into cpu_info::caches, ordered by level
     };
 
     struct physical_core
     {
+      unsigned id = 0;  // unique within the processor pack (and die), not necessarily contiguous
+      unsigned dieId = 0;
+      unsigned clusterId = 0;
+
       std::vector< logical_core > logicalCores;      
     };
 
     struct processor_pack
     {
+      unsigned id = 0;
       std::string name;
 
       std::vector< physical_core > physicalCores;
     };
 
+    //! a single cache instance, e.g. the L2 cache of one physical core
+    struct cache
+    {
+      unsigned level = 0;
+      cache_type type = cache_type::unknown;
+
+      std::uint64_t sizeInBytes = 0;
+      unsigned lineSizeInBytes = 0;
+      unsigned associativity = 0;  // number of ways, 0 if unknown
+
+      std::vector< unsigned > logicalCores;  // cpu_info::logical_core::id of the cores sharing the instance
+    };
+
     std::vector< processor_pack > processorPacks;
+    std::vector< cache > caches;
+  };
+
+
+
+  //! the share of the processors the process may use, e.g. when running in a container
+  struct cpu_budget
+  {
+    double logicalCores = 0.0;  // fractional, e.g. 1.5 for a quota of 150ms per 100ms period
+
+    std::vector< unsigned > allowedLogicalCores;  // cpu_info::logical_core::id, affinity mask and cpuset
+
+    std::uint64_t quotaInMicroseconds = 0;   // the tightest cgroup cpu quota, 0 if there is none
+    std::uint64_t periodInMicroseconds = 0;  // the period the quota refers to
+  };
+
+
+
+  //! accumulated processor times since boot, in clock ticks
+  struct cpu_times
+  {
+    struct logical_core
+    {
+      std::uint64_t user = 0;
+      std::uint64_t nice = 0;
+      std::uint64_t system = 0;
+      std::uint64_t idle = 0;
+      std::uint64_t iowait = 0;
+      std::uint64_t irq = 0;
+      std::uint64_t softirq = 0;
+      std::uint64_t steal = 0;
+    };
+
+    logical_core total;
+    std::vector< logical_core > logicalCores;  // indexed by cpu_info::logical_core::id
+  };
+
+
+  //! processor utilization between two cpu_times snapshots, in percent
+  struct cpu_load
+  {
+    struct logical_core
+    {
+      double userPercent = 0.0;
+      double nicePercent = 0.0;
+      double systemPercent = 0.0;
+      double idlePercent = 0.0;
+      double iowaitPercent = 0.0;
+      double irqPercent = 0.0;
+      double softirqPercent = 0.0;
+      double stealPercent = 0.0;
+
+      double busyPercent = 0.0;  // everything but idle and iowait
+    };
+
+    logical_core total;
+    std::vector< logical_core > logicalCores;  // indexed by cpu_info::logical_core::id
   };
 
 
 
+  struct numa_info
+  {
+    struct node
+    {
+      unsigned id = 0;
+
+      std::vector< unsigned > logicalCores;    // cpu_info::logical_core::id of the cores local to the node
+      std::vector< unsigned > processorPacks;  // cpu_info::processor_pack::id of the packs the cores belong to
+
+      std::uint64_t totalMemoryInBytes = 0;
+      std::uint64_t freeMemoryInBytes = 0;
+
+      std::vector< unsigned > distances;  // relative access cost to each node (local access = 10), by node id
+    };
+
+    std::vector< node > nodes;  // indexed by node id, ids without a node have neither cores nor memory
+  };
+
+
+
+  const std::uint64_t unlimitedMemory = std::numeric_limits< std::uint64_t >::max();
+
+
+  //! the memory limits and usage of the (linux) cgroup the process belongs to
+  struct cgroup_memory_info
+  {
+    std::uint64_t limitInBytes = unlimitedMemory;      // memory.max, the tightest one along the hierarchy
+    std::uint64_t highInBytes = unlimitedMemory;       // memory.high, allocations above are throttled
+    std::uint64_t swapLimitInBytes = unlimitedMemory;  // memory.swap.max
+    std::uint64_t usageInBytes = 0;                    // memory.current, including the page cache
+
+    std::uint64_t anonInBytes = 0;
+    std::uint64_t fileInBytes = 0;  // page cache, partly reclaimable
+    std::uint64_t kernelInBytes = 0;
+    std::uint64_t shmemInBytes = 0;
+  };
+
+
   struct memory_info
   {
     std::uint64_t totalPhysicalMemoryInBytes = 0;
-    std::uint64_t availablePhysicalMemoryInBytes = 0;
+    std::uint64_t availablePhysicalMemoryInBytes = 0;  // memory that can be allocated without swapping
+    std::uint64_t freePhysicalMemoryInBytes = 0;       // memory that is not used at all (not even as cache)
     std::uint64_t totalVirtualMemoryInBytes = 0;
     std::uint64_t availableVirtualMemoryInBytes = 0;
+
+    //! the tighter one of the available physical memory and the headroom below the cgroup's limits
+    std::uint64_t effectiveAvailablePhysicalMemoryInBytes = 0;
+
+    cgroup_memory_info cgroup;
+  };
+
+
+
+  enum class transparent_hugepage_mode
+  {
+    unknown,
+    always,
+    madvise,        // only for regions marked with madvise( MADV_HUGEPAGE )
+    never,
+    defer,          // defrag only, kswapd / kcompactd reclaim in the background instead of stalling
+    defer_madvise   // defrag only, stall for madvised regions and defer for all others
+  };
+
+
+  //! the explicit (hugetlbfs) huge page pools and the transparent huge page usage
+  struct hugepage_info
+  {
+    struct node_pool
+    {
+      unsigned nodeId = 0;  // numa_info::node::id
+      std::uint64_t totalPages = 0;
+      std::uint64_t freePages = 0;
+      std::uint64_t surplusPages = 0;
+    };
+
+    struct pool
+    {
+      std::uint64_t pageSizeInBytes = 0;
+      std::uint64_t totalPages = 0;
+      std::uint64_t freePages = 0;
+      std::uint64_t reservedPages = 0;  // promised to mappings, but not faulted in yet
+      std::uint64_t surplusPages = 0;   // allocated beyond totalPages through overcommit
+
+      std::vector< node_pool > nodes;
+    };
+
+    std::vector< pool > pools;  // ordered by page size
+
+    transparent_hugepage_mode transparentHugepages = transparent_hugepage_mode::unknown;
+    transparent_hugepage_mode transparentHugepageDefrag = transparent_hugepage_mode::unknown;
+    std::uint64_t transparentHugepageSizeInBytes = 0;
+
+    std::uint64_t anonHugepagesInBytes = 0;   // transparent huge pages in use, system wide
+    std::uint64_t shmemHugepagesInBytes = 0;
+    std::uint64_t processAnonHugepagesInBytes = 0;   // the share of the calling process
+    std::uint64_t processShmemHugepagesInBytes = 0;
+  };
+
+
+
+  enum class pressure_resource
+  {
+    cpu,
+    memory,
+    io
+  };
+
+
+  enum class pressure_scope
+  {
+    system,  // the whole machine, /proc/pressure
+    cgroup   // the (v2) cgroup of the process
+  };
+
+
+  enum class pressure_stall
+  {
+    some,  // at least one task was stalled
+    full   // all non-idle tasks were stalled at the same time
+  };
+
+
+  //! pressure stall information (psi), the share of time tasks waited for a resource
+  struct pressure_info
+  {
+    struct stall
+    {
+      double avg10 = 0.0;   // in percent, averaged over 10 seconds
+      double avg60 = 0.0;
+      double avg300 = 0.0;
+      std::uint64_t totalInMicroseconds = 0;
+    };
+
+    stall some;
+    stall full;  // always 0 for the cpu on a system level before linux 5.13
+  };
+
+
+  //! a kernel psi trigger, it fires when tasks stalled for longer than a threshold within a time window
+  class pressure_trigger
+  {
+  public:
+    //! the window has to be between 500ms and 10s, throws invalid_request if psi is not supported
+    pressure_trigger(
+      pressure_resource resource_,
+      pressure_stall stall_,
+      std::chrono::microseconds threshold_,
+      std::chrono::microseconds window_,
+      pressure_scope scope_ = pressure_scope::system
+    );
+    ~pressure_trigger();
+
+    pressure_trigger( pressure_trigger&& other_ );
+    pressure_trigger& operator=( pressure_trigger&& other_ );
+
+    pressure_trigger( const pressure_trigger& ) = delete;
+    pressure_trigger& operator=( const pressure_trigger& ) = delete;
+
+    //! blocks until the trigger fires or the timeout expires, returns true if it fired
+    bool wait( std::chrono::milliseconds timeout_ );
+
+    //! the file descriptor, e.g. for an epoll based event loop (the trigger signals POLLPRI)
+    int native_handle() const { return m_handle; }
+
+  private:
+    int m_handle = -1;
   };
 
 
@@ -103,7 +355,40 @@ namespace platform
 
   cpu_info    get_cpu_info();
 
+  //! refreshes the current speed of all logical cores in place, doesn't allocate once it has run for info_
+  void        update_cpu_info( cpu_info& info_ );
+
+  //! combines the affinity mask of the process with the cpuset and cpu quota of its cgroup (linux)
+  cpu_budget  get_cpu_budget();
+
+  //! takes a snapshot of the processor times, doesn't allocate when times_ is reused
+  void        get_cpu_times( cpu_times& times_ );
+
+  //! computes the utilization between two snapshots, doesn't allocate when load_ is reused
+  void        get_cpu_load( const cpu_times& previous_, const cpu_times& current_, cpu_load& load_ );
+
+  numa_info   get_numa_info();
+
+  //! cheap enough to be polled, the files are kept open on linux
   memory_info get_memory_info();  //! \todo this is also static and dynamic information mixed
+
+  hugepage_info get_hugepage_info();
+
+  //! the base page size followed by the supported huge page sizes in ascending order, determined once
+  const std::vector< std::uint64_t >& get_page_sizes();
+
+  //! reads /proc/pressure or the cgroup's *.pressure file, throws invalid_request if psi is not supported
+  pressure_info get_pressure_info( 
+    pressure_resource resource_, 
+    pressure_scope scope_ = pressure_scope::system 
+  );
+
+  //! waits until at least one of the triggers fires or the timeout expires (a negative timeout waits
+  //! indefinitely), returns the indices of the triggers that fired
+  std::vector< size_t > wait_for_pressure( 
+    const std::vector< pressure_trigger* >& triggers_, 
+    std::chrono::milliseconds timeout_ 
+  );
   
   gpu_info    get_gpu_info();
 
@@ -112,6 +397,27 @@ namespace platform
 
   size_t get_logical_core_count( const platform::cpu_info& cpu_ );
 
+  //! the number of threads needed to use up the budget, the fractional budget is rounded up (at least 1)
+  size_t get_effective_core_count( const platform::cpu_budget& budget_ );
+
+  //! a copy of cpu_ reduced to the given logical cores, e.g. cpu_budget::allowedLogicalCores; physical cores,
+  //! processor packs and caches without any of them are removed
+  cpu_info restrict_cpu_info( const platform::cpu_info& cpu_, const std::vector< unsigned >& logicalCores_ );
+
+
+  //! the data (or unified) cache of the given level used by a logical core, nullptr if there is none
+  const cpu_info::cache* find_cache( const platform::cpu_info& cpu_, unsigned logicalCoreID_, unsigned level_ );
+
+  //! the smallest share of a data (or unified) cache level that each logical core gets if all cores are busy
+  std::uint64_t get_cache_size_per_logical_core( const platform::cpu_info& cpu_, unsigned level_ );
+
+  //! the logical cores sharing the data (or unified) cache of the given level with a logical core
+  std::vector< unsigned > get_cores_sharing_cache( 
+    const platform::cpu_info& cpu_, 
+    unsigned logicalCoreID_, 
+    unsigned level_ 
+  );
+
 }  // namespace platform
 }  // namespace systeminfo
 }  // namespace ll
@@ -127,4 +433,10 @@ namespace ll
 
   std::string to_string( ll::systeminfo::platform::device_type t_ );
 
+  std::string to_string( ll::systeminfo::platform::cache_type t_ );
+
+  std::string to_string( ll::systeminfo::platform::transparent_hugepage_mode m_ );
+
+  std::string to_string( ll::systeminfo::platform::pressure_resource r_ );
+
 }  // namespace ll
\ No newline at end of file
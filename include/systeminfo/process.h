@@ -0,0 +1,185 @@
+/*************************************************************************************************************
+
+ Limelight Framework - SystemInfo Utils
+
+
+ Copyright 2016 mvd
+
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in
+ compliance with the License. You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software distributed under the License is
+ distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and limitations under the License.
+
+*************************************************************************************************************/
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+namespace ll
+{
+namespace systeminfo
+{
+namespace process
+{
+  // ---------------------------------------------------------------------------------------------------------
+  // Types
+  // ---------------------------------------------------------------------------------------------------------
+
+  enum class scan_proportional_set
+  {
+    exclude,
+    include   // walks the page tables of the process (linux smaps_rollup), expensive for large processes
+  };
+
+
+  //! a snapshot of the resources used by the calling process
+  struct resource_usage
+  {
+    std::chrono::steady_clock::time_point timestamp;
+
+    std::uint64_t residentSetInBytes = 0;
+    std::uint64_t peakResidentSetInBytes = 0;
+    std::uint64_t proportionalSetInBytes = 0;  // shared pages divided by their users, see scan_proportional_set
+    std::uint64_t virtualMemoryInBytes = 0;
+
+    std::uint64_t minorPageFaults = 0;
+    std::uint64_t majorPageFaults = 0;  // page faults that required i/o
+
+    std::uint64_t voluntaryContextSwitches = 0;    // the process waited for a resource, e.g. i/o or a lock
+    std::uint64_t involuntaryContextSwitches = 0;  // the scheduler preempted the process
+
+    unsigned threadCount = 0;
+    unsigned openFileDescriptors = 0;  // including the ones the library keeps open for refreshing
+
+    std::chrono::microseconds userTime{ 0 };
+    std::chrono::microseconds systemTime{ 0 };
+  };
+
+
+  //! the change between two snapshots, normalized to one second
+  struct resource_rates
+  {
+    double userCpuPercent = 0.0;    // 100% per fully used core, can exceed 100% for multiple threads
+    double systemCpuPercent = 0.0;
+
+    double minorPageFaultsPerSecond = 0.0;
+    double majorPageFaultsPerSecond = 0.0;
+
+    double voluntaryContextSwitchesPerSecond = 0.0;
+    double involuntaryContextSwitchesPerSecond = 0.0;
+
+    double residentSetChangeInBytesPerSecond = 0.0;
+  };
+
+
+  enum class scan_context_switches
+  {
+    exclude,
+    include   // reads a second, larger file per thread on linux (/proc/self/task/<tid>/status)
+  };
+
+
+  enum class thread_state
+  {
+    unknown,
+    running,     // running or runnable
+    sleeping,    // interruptible wait, e.g. for a lock or a socket
+    disk_sleep,  // uninterruptible wait, usually for i/o
+    stopped,     // stopped by a signal or a debugger
+    zombie,
+    idle         // idle kernel thread
+  };
+
+
+  struct thread_usage
+  {
+    std::uint64_t id = 0;  // the os thread id, e.g. the linux tid
+    std::string name;      // at most 15 characters on linux
+    thread_state state = thread_state::unknown;
+    unsigned lastProcessor = 0;  // cpu_info::logical_core::id of the core the thread ran on last
+
+    // accumulated over the lifetime of the thread
+    std::chrono::microseconds userTime{ 0 };
+    std::chrono::microseconds systemTime{ 0 };
+    std::uint64_t voluntaryContextSwitches = 0;
+    std::uint64_t involuntaryContextSwitches = 0;
+
+    // since the previous sample, the accumulated values for threads that didn't exist back then
+    std::chrono::microseconds userTimeDelta{ 0 };
+    std::chrono::microseconds systemTimeDelta{ 0 };
+    std::uint64_t voluntaryContextSwitchesDelta = 0;
+    std::uint64_t involuntaryContextSwitchesDelta = 0;
+  };
+
+
+  namespace impl
+  {
+    class thread_reader;
+  }
+
+  //! samples the threads of the calling process, the per thread files are kept open between samples; on
+  //! linux the stat file of a thread is only read if the thread ran since the last sample, the context
+  //! switches cost another read per thread
+  class thread_sampler
+  {
+  public:
+    explicit thread_sampler( scan_context_switches scan_ = scan_context_switches::exclude );
+    ~thread_sampler();
+
+    thread_sampler( const thread_sampler& ) = delete;
+    thread_sampler& operator=( const thread_sampler& ) = delete;
+
+    //! refreshes the threads ordered by id, only allocates if threads have been created since the last sample
+    const std::vector< thread_usage >& sample();
+
+    //! the time between the last two samples, e.g. to turn the deltas into percentages
+    std::chrono::steady_clock::duration interval() const { return m_current - m_previous; }
+
+  private:
+    std::unique_ptr< impl::thread_reader > m_reader;
+    std::vector< thread_usage > m_threads;
+    std::vector< thread_usage > m_previousThreads;
+    std::chrono::steady_clock::time_point m_previous;
+    std::chrono::steady_clock::time_point m_current;
+  };
+
+
+  // ---------------------------------------------------------------------------------------------------------
+  // Functions
+  // ---------------------------------------------------------------------------------------------------------
+
+  resource_usage get_resource_usage( scan_proportional_set scan_ = scan_proportional_set::exclude );
+
+  //! refreshes a snapshot in place without allocating, the files are kept open between calls
+  void update_resource_usage( 
+    resource_usage& usage_, 
+    scan_proportional_set scan_ = scan_proportional_set::exclude 
+  );
+
+  resource_rates get_resource_rates( const resource_usage& previous_, const resource_usage& current_ );
+
+}  // namespace process
+}  // namespace systeminfo
+}  // namespace ll
+
+
+// -----------------------------------------------------------------------------------------------------------
+// Utilities
+// -----------------------------------------------------------------------------------------------------------
+
+namespace ll
+{
+
+  std::string to_string( ll::systeminfo::process::thread_state s_ );
+
+}  // namespace ll
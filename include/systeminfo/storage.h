@@ -24,7 +24,12 @@ LL_WARNING_DISABLE_GCC( deprecated-declarations )
 #include <boost/filesystem/path.hpp>
 LL_WARNING_ENABLE_GCC( deprecated-declarations )
 
+#include <chrono>
 #include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
 
 
 
@@ -51,7 +56,13 @@ namespace storage
     smb,
     afp,
     nfs,
-    ext4
+    ext4,
+    xfs,
+    btrfs,
+    tmpfs,
+    overlay,
+    zfs,
+    nfs4
   };
 
   enum class storage_type
@@ -60,6 +71,18 @@ namespace storage
     harddisk,
     removable,
     network,      
+    solid_state
+  };
+
+  enum class storage_transport
+  {
+    unknown,
+    ata,     // sata and pata
+    scsi,    // including sas
+    nvme,
+    virtio,
+    usb,
+    mmc      // sd cards and emmc
   };
 
   enum class scan_network_storage
@@ -67,10 +90,44 @@ namespace storage
     exclude,
     include
   };
+
+  enum class capacity_state
+  {
+    current,
+    stale,     // the file system didn't answer in time, the sizes are the ones of an earlier query
+    timed_out  // the file system didn't answer in time and never has before, the sizes are 0
+  };
+
+
+  //! how get_storage_info queries the volumes, an unresponsive network file system can't block the caller
+  struct storage_query
+  {
+    scan_network_storage scan = scan_network_storage::include;
+    std::chrono::milliseconds timeout{ 2000 };  // for all volumes, they are queried in parallel
+    unsigned parallelQueries = 4;
+  };
       
 
   struct storage_info
   {
+    //! the disk a volume is stored on, relevant for i/o sizes and the alignment of O_DIRECT (linux)
+    struct block_device
+    {
+      std::string name;  // the whole disk, e.g. nvme0n1 for nvme0n1p2, dm-0 for a logical volume
+      storage_transport transport = storage_transport::unknown;  // of the underlying disk for dm and md
+      bool rotational = false;
+      bool removable = false;
+
+      unsigned logicalBlockSize = 0;   // the smallest addressable unit, the alignment O_DIRECT requires
+      unsigned physicalBlockSize = 0;  // writes of smaller units need a read-modify-write cycle
+      unsigned minimumIoSize = 0;
+      unsigned optimalIoSize = 0;      // 0 if the device doesn't report it, e.g. the stripe width of a raid
+
+      unsigned queueDepth = 0;         // the requests the block layer queues (nr_requests)
+      unsigned readAheadInKilobytes = 0;
+      std::string scheduler;           // the active i/o scheduler, e.g. none, mq-deadline, bfq
+    };
+
     struct volume
     {
       std::string name;
@@ -80,7 +137,12 @@ namespace storage
 
       std::uint64_t totalSizeInBytes = 0;
       std::uint64_t availableSizeInBytes = 0;
+      capacity_state capacity = capacity_state::current;
 
+      // the block device the volume is mounted from, 0:0 if there is none (linux)
+      unsigned deviceMajor = 0;
+      unsigned deviceMinor = 0;
+      block_device device;
       
       //! \todo drive serial
     };
@@ -89,12 +151,365 @@ namespace storage
   };
 
 
+  //! a file system with all the paths it's mounted to, e.g. by bind mounts into containers
+  struct filesystem_info
+  {
+    storage_info::volume volume;          // the path is the first mount point
+    std::uint64_t deviceId = 0;           // equals the st_dev of stat(2) for files on it (linux)
+    std::vector< fs::path > mountPoints;  // in the order of the mount table, without hidden ones
+  };
+
+
+  //! the i/o statistics of a block device, e.g. a disk or a partition (linux /proc/diskstats)
+  struct device_io
+  {
+    std::string name;  // e.g. sda, sda1, nvme0n1, dm-0
+    unsigned major = 0;
+    unsigned minor = 0;
+
+    // accumulated since boot
+    std::uint64_t reads = 0;
+    std::uint64_t readBytes = 0;
+    std::chrono::milliseconds readTime{ 0 };
+    std::uint64_t writes = 0;
+    std::uint64_t writeBytes = 0;
+    std::chrono::milliseconds writeTime{ 0 };
+    std::chrono::milliseconds ioTime{ 0 };          // the time the device was busy
+    std::chrono::milliseconds weightedIoTime{ 0 };  // the busy time multiplied by the requests in flight
+    unsigned requestsInFlight = 0;                  // at the time of the sample
+
+    // since the previous sample, 0 for devices that didn't exist back then
+    double readsPerSecond = 0.0;
+    double writesPerSecond = 0.0;
+    double readBytesPerSecond = 0.0;
+    double writeBytesPerSecond = 0.0;
+    double averageReadLatencyInMilliseconds = 0.0;
+    double averageWriteLatencyInMilliseconds = 0.0;
+    double averageQueueDepth = 0.0;
+    double utilizationPercent = 0.0;  // unreliable for devices that serve requests in parallel, e.g. nvme
+  };
+
+
+  //! in microseconds
+  struct latency_distribution
+  {
+    double minimum = 0.0;
+    double mean = 0.0;
+    double p50 = 0.0;
+    double p90 = 0.0;
+    double p99 = 0.0;
+    double p999 = 0.0;
+    double maximum = 0.0;
+  };
+
+
+  //! what a file system and its device support, probed with a scratch file (linux)
+  struct io_capabilities
+  {
+    storage_info::volume volume;  // the mount the directory is on, also e.g. tmpfs or overlay (linux)
+
+    bool directIo = false;                 // O_DIRECT
+    unsigned directIoMemoryAlignment = 0;  // the alignment O_DIRECT requires for buffers
+    unsigned directIoOffsetAlignment = 0;  // the alignment O_DIRECT requires for file offsets and sizes
+    unsigned optimalBlockSize = 0;         // the preferred size of an i/o request (st_blksize)
+
+    bool fallocate = false;      // preallocation without writing zeros
+    bool punchHole = false;      // deallocating a range in the middle of a file
+    bool copyFileRange = false;  // copying within the kernel, without a round trip through user space
+    bool reflink = false;        // copy on write clones of a file (FICLONE)
+    bool ioUring = false;        // io_uring is enabled and can open files in the directory
+  };
+
+
+  enum class volume_change
+  {
+    added,
+    removed,
+    changed  // e.g. remounted with different options
+  };
+
+
+  struct volume_event
+  {
+    volume_change change = volume_change::added;
+    storage_info::volume volume;  // the last known state for removed volumes
+  };
+
+
+  //! a file on a volume the latency_canary reads from
+  struct canary_target
+  {
+    storage_info::volume volume;
+    fs::path file;  // absolute, on the volume and at least 256 KiB, see canary_options::createFile
+  };
+
+
+  //! the state of a volume as seen by the latency_canary
+  struct canary_status
+  {
+    storage_info::volume volume;
+    fs::path file;
+    latency_distribution latency;  // of the reads in the rolling window
+    std::uint64_t reads = 0;
+    std::uint64_t failures = 0;
+    int lastError = 0;             // the errno of the last failed read, or of opening the file
+
+    bool active = false;   // false until the file is opened, and if it can't be opened
+    bool stalled = false;  // a read has been outstanding for longer than the threshold
+    bool slow = false;     // the p99 of the window exceeds the threshold, or stalled
+  };
+
+
+  enum class space_level
+  {
+    normal,
+    low,
+    critical
+  };
+
+
+  //! in available bytes, i.e. what's left for unprivileged users
+  struct space_watermarks
+  {
+    std::uint64_t lowInBytes = 0;
+    std::uint64_t criticalInBytes = 0;
+    std::uint64_t hysteresisInBytes = 0;  // a level is only left this far above its watermark
+  };
+
+
+  struct space_event
+  {
+    storage_info::volume volume;  // with the sizes of the check that changed the level
+    space_level level = space_level::normal;
+    space_level previousLevel = space_level::normal;
+    double fillRateInBytesPerSecond = 0.0;  // smoothed, negative while space is freed
+    double secondsUntilFull = 0.0;          // at the current fill rate, 0 if the volume doesn't fill up
+  };
+
+
+  struct space_options
+  {
+    std::chrono::milliseconds minimumInterval{ 500 };    // for a volume that's about to cross a watermark
+    std::chrono::milliseconds maximumInterval{ 60000 };  // for a volume whose usage doesn't change
+    std::chrono::milliseconds timeout{ 2000 };           // for the query of an unresponsive network volume
+  };
+
+
+  struct canary_options
+  {
+    std::chrono::milliseconds interval{ 1000 };
+    std::chrono::milliseconds p99Threshold{ 50 };
+    size_t windowSize = 300;     // the number of reads the rolling distribution is computed from
+    size_t minimumSamples = 20;  // a volume isn't flagged because of its p99 before it has that many
+
+    //! creates a missing target file, or extends a short one, to 256 KiB and keeps it for the next canary;
+    //! otherwise such a volume stays inactive with lastError ENOENT or EINVAL
+    bool createFile = false;
+
+    //! called from a canary thread when a volume becomes slow or recovers; a stalled read is only reported by
+    //! status() until it returns, since the thread that would call back is blocked by it
+    std::function< void( const canary_status& ) > onChange;
+  };
+
+
+  namespace impl
+  {
+    class io_reader;
+    class mount_reader;
+    struct canary_volume;
+    struct canary_callback;
+    struct space_watches;
+  }
+
+  //! samples the i/o statistics of all block devices, the statistics file is kept open between samples
+  class io_sampler
+  {
+  public:
+    io_sampler();
+    ~io_sampler();
+
+    io_sampler( const io_sampler& ) = delete;
+    io_sampler& operator=( const io_sampler& ) = delete;
+
+    //! refreshes the devices ordered by major:minor, only allocates if devices have been added
+    const std::vector< device_io >& sample();
+
+    //! the time between the last two samples
+    std::chrono::steady_clock::duration interval() const { return m_current - m_previous; }
+
+    //! the device of a volume in the last sample, nullptr if the volume isn't mounted from a block device
+    const device_io* find( const storage_info::volume& volume_ ) const;
+
+  private:
+    std::unique_ptr< impl::io_reader > m_reader;
+    std::vector< device_io > m_devices;
+    std::vector< device_io > m_previousDevices;
+    std::chrono::steady_clock::time_point m_previous;
+    std::chrono::steady_clock::time_point m_current;
+  };
+
+
+  //! keeps a storage_info up to date without rescanning every mount, the mount table is only parsed when
+  //! the kernel signals a change, and only new or changed mounts are queried (linux)
+  class mount_watcher
+  {
+  public:
+    //! reads the complete mount table once, throws invalid_request if changes can't be watched
+    explicit mount_watcher( scan_network_storage scan_ = scan_network_storage::include );
+    ~mount_watcher();
+
+    mount_watcher( const mount_watcher& ) = delete;
+    mount_watcher& operator=( const mount_watcher& ) = delete;
+
+    //! waits up to timeout_ for a change of the mount table and applies it, empty if nothing changed
+    const std::vector< volume_event >& update( 
+      std::chrono::milliseconds timeout_ = std::chrono::milliseconds( 0 ) 
+    );
+
+    //! re-reads the mount table without waiting for a change and applies the differences
+    const std::vector< volume_event >& refresh();
+
+    //! the volumes as of the last update, the sizes are the ones from when a volume was added or changed
+    const storage_info& info() const { return m_info; }
+
+    //! the file descriptor, e.g. for an epoll based event loop; a change signals POLLPRI only once, so after
+    //! the loop saw it call refresh(), update() would wait for the next change
+    int native_handle() const;
+
+  private:
+    std::unique_ptr< impl::mount_reader > m_reader;
+    storage_info m_info;
+    std::vector< volume_event > m_events;
+  };
+
+
+  //! answers which volume a path is stored on from a snapshot of the mount table, without system calls;
+  //! bind mounts resolve to the volume they are taken from, overlays to the volume of their upper directory
+  //! and paths on other file systems (e.g. /proc or a tmpfs) to nullptr
+  class volume_resolver
+  {
+  public:
+    //! reads the mount table and the volumes once
+    explicit volume_resolver( scan_network_storage scan_ = scan_network_storage::include );
+
+    //! resolves to the volumes of info_, e.g. the info() of a mount_watcher; create a new resolver when the
+    //! watcher reports a change
+    explicit volume_resolver( storage_info info_ );
+
+    //! in O(depth of the path); the path is resolved lexically, so it has to be absolute and shouldn't
+    //! contain symbolic links or "..", see fs::canonical()
+    const storage_info::volume* resolve( const fs::path& path_ ) const;
+    const storage_info::volume* resolve( const char* begin_, const char* end_ ) const;
+
+    //! resolves all paths_ into volumes_, which is reused
+    void resolve( 
+      const std::vector< fs::path >& paths_, 
+      std::vector< const storage_info::volume* >& volumes_ 
+    ) const;
+
+    const storage_info& info() const { return m_info; }
+
+  private:
+    struct node
+    {
+      std::vector< std::pair< std::string, std::uint32_t > > children;  // ordered by name
+      bool mountPoint = false;
+      std::int32_t volume = -1;  // the index in m_info.volumes, -1 if the mount point isn't a volume
+    };
+
+    void build();
+    std::uint32_t insert( const std::string& path_ );
+    const node* find_mount( const char* begin_, const char* end_ ) const;
+
+    storage_info m_info;
+    std::vector< node > m_nodes;  // the root is the first node
+  };
+
+
+  //! calls back when the available space of a volume crosses a watermark; all watchers share one timer
+  //! thread, which checks a volume more often the faster it fills up and less often while it's idle
+  class space_watcher
+  {
+  public:
+    using callback = std::function< void( const space_event& ) >;
+
+    explicit space_watcher( const space_options& options_ = space_options() );
+
+    //! removes the watches, waits for a callback that's running on the timer thread, but may be called from
+    //! a callback itself
+    ~space_watcher();
+
+    space_watcher( const space_watcher& ) = delete;
+    space_watcher& operator=( const space_watcher& ) = delete;
+
+    //! the volume is checked right away, callback_ is called from the timer thread on every change of the
+    //! level, including the first check if the volume is already low; replaces an earlier watch of the path
+    void watch( 
+      const storage_info::volume& volume_, 
+      const space_watermarks& watermarks_, 
+      callback callback_ 
+    );
+
+    void unwatch( const fs::path& path_ );
+
+    //! the last check of each watched volume
+    std::vector< space_event > status() const;
+
+  private:
+    std::shared_ptr< impl::space_watches > m_watches;
+  };
+
+
+  //! reads a small block of a file on each volume at a fixed interval, bypassing the page cache with
+  //! O_DIRECT, and keeps a rolling latency distribution per volume (linux)
+  class latency_canary
+  {
+  public:
+    //! each volume has its own thread with at most one outstanding read, the files are opened by these
+    //! threads, so an unresponsive network volume never blocks the caller; throws invalid_parameter if a
+    //! file isn't absolute
+    explicit latency_canary( 
+      const std::vector< canary_target >& targets_, 
+      const canary_options& options_ = canary_options() 
+    );
+
+    //! doesn't wait for outstanding reads, their threads end when the reads return; waits for a running
+    //! onChange of another thread, but may be called from onChange itself
+    ~latency_canary();
+
+    latency_canary( const latency_canary& ) = delete;
+    latency_canary& operator=( const latency_canary& ) = delete;
+
+    //! in the order of the targets passed to the constructor
+    std::vector< canary_status > status() const;
+
+    std::vector< canary_status > slow_volumes() const;
+
+  private:
+    std::shared_ptr< impl::canary_callback > m_callback;
+    std::vector< std::shared_ptr< impl::canary_volume > > m_volumes;
+  };
+
+
   // ---------------------------------------------------------------------------------------------------------
   // Functions
   // ---------------------------------------------------------------------------------------------------------
 
   storage_info get_storage_info( scan_network_storage scan_ = scan_network_storage::include );
 
+  storage_info get_storage_info( const storage_query& query_ );
+
+  //! one entry per file system rather than per mount point, each file system is queried only once
+  std::vector< filesystem_info > get_filesystems( 
+    scan_network_storage scan_ = scan_network_storage::include 
+  );
+
+  std::vector< filesystem_info > get_filesystems( const storage_query& query_ );
+
+  //! the probe results are cached per mounted file system, the volume and its sizes are always current;
+  //! throws invalid_parameter if directory_ isn't writable
+  io_capabilities get_io_capabilities( const fs::path& directory_ );
+
   
 }  // namespace storage
 }  // namespace systeminfo
@@ -109,5 +524,9 @@ namespace ll
 {
 
   std::string to_string( ll::systeminfo::storage::storage_type t_ );
+
+  std::string to_string( ll::systeminfo::storage::storage_transport t_ );
+
+  std::string to_string( ll::systeminfo::storage::space_level l_ );
  
 }  // namespace ll
@@ -0,0 +1,198 @@
+/*************************************************************************************************************
+
+ Limelight Framework - SystemInfo Utils
+
+
+ Copyright 2016 mvd
+
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in
+ compliance with the License. You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software distributed under the License is
+ distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and limitations under the License.
+
+*************************************************************************************************************/
+
+#include "systeminfo/affinity.h"
+#include "systeminfo/exception.h"
+#include "platform_impl.h"
+
+#include <algorithm>
+
+
+namespace ll
+{
+namespace systeminfo
+{
+namespace platform
+{
+  namespace
+  {
+    using core_list_t = std::vector< unsigned >;     // the usable logical cores of a physical core
+    using pack_list_t = std::vector< core_list_t >;  // the usable physical cores of a processor pack
+
+
+    //! one logical core of every physical core first, then the second smt siblings and so on
+    void append_physical_cores_first( const std::vector< pack_list_t >& packs_, core_list_t& result_ )
+    {
+      for( size_t sibling = 0;; ++sibling )
+      {
+        bool found = false;
+        for( const auto& p : packs_ )
+        {
+          for( const auto& c : p )
+          {
+            if( sibling < c.size() )
+            {
+              result_.push_back( c[ sibling ] );
+              found = true;
+            }
+          }
+        }
+
+        if( !found )
+          break;
+      }
+    }
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  std::vector< unsigned > plan_thread_affinity( 
+    const cpu_info& cpu_, 
+    size_t threadCount_, 
+    const affinity_options& options_ 
+  )
+  {
+    auto usable = [&options_]( const cpu_info::logical_core& l_ )
+    {
+      if( options_.excludeIsolatedCores && l_.isolated )
+        return false;
+
+      const auto& excluded = options_.excludedCores;
+      return std::find( excluded.begin(), excluded.end(), l_.id ) == excluded.end();
+    };
+
+    std::vector< pack_list_t > packs;
+    for( const auto& p : cpu_.processorPacks )
+    {
+      pack_list_t pack;
+      for( const auto& c : p.physicalCores )
+      {
+        core_list_t core;
+        for( const auto& l : c.logicalCores )
+        {
+          if( usable( l ) )
+            core.push_back( l.id );
+        }
+
+        if( !core.empty() )
+          pack.push_back( core );
+      }
+
+      if( !pack.empty() )
+        packs.push_back( pack );
+    }
+
+    core_list_t order;
+    switch( options_.policy )
+    {
+      case affinity_policy::compact:
+      {
+        // start with the pack offering the most cores, so small thread counts stay on a single pack
+        std::stable_sort( packs.begin(), packs.end(), []( const pack_list_t& lhs_, const pack_list_t& rhs_ ) 
+        { 
+          return lhs_.size() > rhs_.size(); 
+        } );
+
+        for( const auto& p : packs )
+          append_physical_cores_first( std::vector< pack_list_t >( 1, p ), order );
+        break;
+      }
+
+      case affinity_policy::spread:
+      {
+        std::vector< core_list_t > packOrders( packs.size() );
+        for( size_t i = 0; i < packs.size(); ++i )
+          append_physical_cores_first( std::vector< pack_list_t >( 1, packs[ i ] ), packOrders[ i ] );
+
+        for( size_t index = 0;; ++index )
+        {
+          bool found = false;
+          for( const auto& p : packOrders )
+          {
+            if( index < p.size() )
+            {
+              order.push_back( p[ index ] );
+              found = true;
+            }
+          }
+
+          if( !found )
+            break;
+        }
+        break;
+      }
+
+      case affinity_policy::physical_cores_first:
+      default:
+        append_physical_cores_first( packs, order );
+        break;
+    }
+
+    std::vector< unsigned > result;
+    if( order.empty() )
+      return result;
+
+    result.reserve( threadCount_ );
+    for( size_t t = 0; t < threadCount_; ++t )
+      result.push_back( order[ t % order.size() ] );
+
+    return result;
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  void set_thread_affinity( std::thread::native_handle_type thread_, const std::vector< unsigned >& cpus_ )
+  {
+    if( cpus_.empty() )
+      throw exception( error::invalid_parameter, "empty processor list" );
+
+    impl::set_thread_affinity( thread_, cpus_ );
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  void set_thread_affinity( std::thread& thread_, const std::vector< unsigned >& cpus_ )
+  {
+    set_thread_affinity( thread_.native_handle(), cpus_ );
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  void set_thread_affinity( std::thread& thread_, unsigned cpu_ )
+  {
+    set_thread_affinity( thread_.native_handle(), std::vector< unsigned >( 1, cpu_ ) );
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  void set_current_thread_affinity( const std::vector< unsigned >& cpus_ )
+  {
+    if( cpus_.empty() )
+      throw exception( error::invalid_parameter, "empty processor list" );
+
+    impl::set_current_thread_affinity( cpus_ );
+  }
+
+} // namespace platform
+} // namespace systeminfo
+} // namespace ll
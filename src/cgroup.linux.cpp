@@ -0,0 +1,186 @@
+/*************************************************************************************************************
+
+ Limelight Framework - SystemInfo Utils
+
+
+ Copyright 2016 mvd
+
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in
+ compliance with the License. You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software distributed under the License is
+ distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and limitations under the License.
+
+*************************************************************************************************************/
+
+#include "cgroup.linux.h"
+#include "file_utils.linux.h"
+
+#include <sstream>
+
+#include <unistd.h>
+
+
+namespace ll
+{
+namespace systeminfo
+{
+namespace detail
+{
+  namespace
+  {
+    struct cgroup_mount
+    {
+      std::string root;  // the directory of the hierarchy that is mounted, "/" unless in a cgroup namespace
+      std::string mountPoint;
+      std::string type;  // cgroup or cgroup2
+      std::string options;
+    };
+
+
+    bool contains_token( const std::string& list_, const std::string& token_, char separator_ )
+    {
+      std::istringstream stream( list_ );
+      std::string t;
+      while( std::getline( stream, t, separator_ ) )
+      {
+        if( t == token_ )
+          return true;
+      }
+      return false;
+    }
+
+
+    //! the cgroup and cgroup2 entries of /proc/<pid>/mountinfo
+    std::vector< cgroup_mount > read_cgroup_mounts( const std::string& path_ )
+    {
+      std::vector< cgroup_mount > result;
+
+      std::string content;
+      if( !read_file( path_, content ) )
+        return result;
+
+      // 36 25 0:31 / /sys/fs/cgroup/cpu,cpuacct rw,nosuid - cgroup cgroup rw,cpu,cpuacct
+      std::istringstream lines( content );
+      std::string line;
+      while( std::getline( lines, line ) )
+      {
+        std::istringstream fields( line );
+        std::string id, parent, device, separator;
+        cgroup_mount m;
+        fields >> id >> parent >> device >> m.root >> m.mountPoint;
+
+        while( ( fields >> separator ) && ( separator != "-" ) )
+          ;
+
+        std::string source;
+        fields >> m.type >> source >> m.options;
+        if( ( m.type == "cgroup" ) || ( m.type == "cgroup2" ) )
+          result.push_back( m );
+      }
+
+      return result;
+    }
+
+
+    //! maps the path from /proc/<pid>/cgroup into the mounted hierarchy
+    std::string to_directory( const cgroup_mount& mount_, std::string path_ )
+    {
+      if( ( mount_.root != "/" ) && ( path_.compare( 0, mount_.root.size(), mount_.root ) == 0 ) )
+        path_ = path_.substr( mount_.root.size() );
+
+      auto directory = mount_.mountPoint;
+      if( !path_.empty() && ( path_ != "/" ) )
+        directory += ( path_[ 0 ] == '/' ) ? path_ : "/" + path_;
+
+      // without a cgroup namespace a container sees the host's path but only its own cgroup is mounted
+      return ( ::access( directory.c_str(), F_OK ) == 0 ) ? directory : mount_.mountPoint;
+    }
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  std::vector< std::string > cgroup::hierarchy() const
+  {
+    std::vector< std::string > result;
+    if( directory.empty() )
+      return result;
+
+    auto d = directory;
+    for( ;; )
+    {
+      result.push_back( d );
+
+      auto separator = d.rfind( '/' );
+      if( ( d.size() <= mountPoint.size() ) || ( separator == std::string::npos ) || ( separator == 0 ) )
+        break;
+
+      d.resize( separator );
+    }
+
+    return result;
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  cgroup find_cgroup( const std::string& controller_, const std::string& processDirectory_ )
+  {
+    cgroup unified;
+    cgroup legacy;
+
+    auto mounts = read_cgroup_mounts( processDirectory_ + "/mountinfo" );
+
+    std::string content;
+    read_file( processDirectory_ + "/cgroup", content );
+
+    // hierarchy-id:controller-list:path, the unified hierarchy has the id 0 and no controllers
+    std::istringstream lines( content );
+    std::string line;
+    while( std::getline( lines, line ) )
+    {
+      auto first = line.find( ':' );
+      auto second = ( first != std::string::npos ) ? line.find( ':', first + 1 ) : std::string::npos;
+      if( second == std::string::npos )
+        continue;
+
+      auto controllers = line.substr( first + 1, second - first - 1 );
+      auto path = line.substr( second + 1 );
+
+      for( const auto& m : mounts )
+      {
+        if( controllers.empty() && ( m.type == "cgroup2" ) && unified.empty() )
+        {
+          unified.directory = to_directory( m, path );
+          unified.mountPoint = m.mountPoint;
+          unified.unified = true;
+        }
+        else if( 
+          !controllers.empty() && ( m.type == "cgroup" ) && legacy.empty() && 
+          contains_token( controllers, controller_, ',' ) && contains_token( m.options, controller_, ',' ) 
+        )
+        {
+          legacy.directory = to_directory( m, path );
+          legacy.mountPoint = m.mountPoint;
+        }
+      }
+    }
+
+    // in hybrid setups the unified hierarchy exists, but the controllers are still bound to v1
+    if( !unified.empty() )
+    {
+      auto available = read_line( unified.mountPoint + "/cgroup.controllers" );
+      if( contains_token( available, controller_, ' ' ) || legacy.empty() )
+        return unified;
+    }
+
+    return legacy;
+  }
+
+}  // namespace detail
+}  // namespace systeminfo
+}  // namespace ll
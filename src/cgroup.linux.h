@@ -0,0 +1,60 @@
+/*************************************************************************************************************
+
+ Limelight Framework - SystemInfo Utils
+
+
+ Copyright 2016 mvd
+
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in
+ compliance with the License. You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software distributed under the License is
+ distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and limitations under the License.
+
+*************************************************************************************************************/
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+
+namespace ll
+{
+namespace systeminfo
+{
+namespace detail
+{
+  // ---------------------------------------------------------------------------------------------------------
+  // Types
+  // ---------------------------------------------------------------------------------------------------------
+
+  //! the location of a cgroup in the file system
+  struct cgroup
+  {
+    std::string directory;   // e.g. /sys/fs/cgroup/kubepods.slice/.../cri-containerd-1234.scope
+    std::string mountPoint;  // the root of the hierarchy as far as it is visible to the process
+    bool unified = false;    // cgroup v2, otherwise the v1 hierarchy of a single controller
+
+    bool empty() const { return directory.empty(); }
+
+    //! the cgroup followed by its parents up to the mount point, the limits of all of them apply
+    std::vector< std::string > hierarchy() const;
+  };
+
+
+  // ---------------------------------------------------------------------------------------------------------
+  // Functions
+  // ---------------------------------------------------------------------------------------------------------
+
+  //! the cgroup of a process for a controller such as "cpu", "cpuset" or "memory", empty if cgroups are not
+  //! mounted; the unified hierarchy is preferred over v1 if it provides the controller, an empty controller_
+  //! selects the unified hierarchy
+  cgroup find_cgroup( const std::string& controller_, const std::string& processDirectory_ = "/proc/self" );
+
+}  // namespace detail
+}  // namespace systeminfo
+}  // namespace ll
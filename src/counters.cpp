@@ -0,0 +1,262 @@
+/*************************************************************************************************************
+
+ Limelight Framework - SystemInfo Utils
+
+
+ Copyright 2016 mvd
+
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in
+ compliance with the License. You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software distributed under the License is
+ distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and limitations under the License.
+
+*************************************************************************************************************/
+
+#include "systeminfo/counters.h"
+#include "systeminfo/exception.h"
+#include "process_impl.h"
+
+
+namespace ll
+{
+namespace systeminfo
+{
+namespace process
+{
+  namespace
+  {
+    double ratio( const counter_values& values_, counter_event numerator_, counter_event denominator_ )
+    {
+      if( !values_.has( numerator_ ) || !values_.has( denominator_ ) || ( values_.get( denominator_ ) == 0 ) )
+        return 0.0;
+
+      auto numerator = static_cast< double >( values_.get( numerator_ ) );
+      return numerator / static_cast< double >( values_.get( denominator_ ) );
+    }
+
+
+    std::vector< counter_event > all_events()
+    {
+      std::vector< counter_event > events;
+      for( size_t i = 0; i < static_cast< size_t >( counter_event::count ); ++i )
+        events.push_back( static_cast< counter_event >( i ) );
+      return events;
+    }
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  double counter_values::instructions_per_cycle() const
+  {
+    return ratio( *this, counter_event::instructions, counter_event::cycles );
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  double counter_values::cache_miss_ratio() const
+  {
+    return ratio( *this, counter_event::cache_misses, counter_event::cache_references );
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  double counter_values::branch_miss_ratio() const
+  {
+    return ratio( *this, counter_event::branch_misses, counter_event::branches );
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  counter_group::counter_group( counter_target target_, unsigned cpu_ )
+    : m_reader( impl::create_counter_reader( target_, cpu_, all_events() ) )
+  {
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  counter_group::counter_group( 
+    counter_target target_, 
+    unsigned cpu_, 
+    const std::vector< counter_event >& events_ 
+  )
+  {
+    for( auto e : events_ )
+    {
+      if( e >= counter_event::count )
+        throw exception( error::invalid_parameter, "counter event" );
+    }
+
+    m_reader = impl::create_counter_reader( target_, cpu_, events_ );
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  counter_group::~counter_group()
+  {
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  counter_group::counter_group( counter_group&& other_ )
+    : m_reader( std::move( other_.m_reader ) )
+  {
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  counter_group& counter_group::operator=( counter_group&& other_ )
+  {
+    std::swap( m_reader, other_.m_reader );
+    return *this;
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  void counter_group::enable()
+  {
+    if( m_reader )
+      m_reader->enable();
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  void counter_group::disable()
+  {
+    if( m_reader )
+      m_reader->disable();
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  void counter_group::reset()
+  {
+    if( m_reader )
+      m_reader->reset();
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  void counter_group::read( counter_values& values_ ) const
+  {
+    if( m_reader )
+    {
+      m_reader->read( values_ );
+      return;
+    }
+
+    values_ = counter_values();
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  counter_values counter_group::read() const
+  {
+    counter_values values;
+    read( values );
+    return values;
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  const std::bitset< static_cast< size_t >( counter_event::count ) >& counter_group::available() const
+  {
+    static const std::bitset< static_cast< size_t >( counter_event::count ) > s_none;
+    return m_reader ? m_reader->available() : s_none;
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  counter_scope::counter_scope( const counter_group& group_, counter_values& result_ )
+    : m_group( group_ ), m_result( result_ )
+  {
+    m_group.read( m_start );
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  counter_scope::~counter_scope()
+  {
+    m_group.read( m_result );
+    m_result = get_counter_delta( m_start, m_result );
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  counter_values get_counter_delta( const counter_values& previous_, const counter_values& current_ )
+  {
+    counter_values delta;
+    delta.available = previous_.available & current_.available;
+
+    for( size_t i = 0; i < delta.values.size(); ++i )
+    {
+      if( delta.available.test( i ) && ( current_.values[ i ] > previous_.values[ i ] ) )
+        delta.values[ i ] = current_.values[ i ] - previous_.values[ i ];
+    }
+
+    if( current_.timeEnabled > previous_.timeEnabled )
+      delta.timeEnabled = current_.timeEnabled - previous_.timeEnabled;
+    if( current_.timeRunning > previous_.timeRunning )
+      delta.timeRunning = current_.timeRunning - previous_.timeRunning;
+
+    return delta;
+  }
+
+}  // namespace process
+}  // namespace systeminfo
+}  // namespace ll
+
+
+
+namespace ll
+{
+  using namespace systeminfo;
+
+  std::string to_string( process::counter_event e_ )
+  {
+    switch ( e_ )
+    {
+    case process::counter_event::cycles:
+      return "Cycles";
+    case process::counter_event::instructions:
+      return "Instructions";
+    case process::counter_event::cache_references:
+      return "Cache References";
+    case process::counter_event::cache_misses:
+      return "Cache Misses";
+    case process::counter_event::branches:
+      return "Branches";
+    case process::counter_event::branch_misses:
+      return "Branch Misses";
+    case process::counter_event::task_clock:
+      return "Task Clock";
+    case process::counter_event::context_switches:
+      return "Context Switches";
+    case process::counter_event::page_faults:
+      return "Page Faults";
+    default:
+      return "Unknown";
+    }
+  }
+
+} // namespace ll
@@ -0,0 +1,319 @@
+/*************************************************************************************************************
+
+ Limelight Framework - SystemInfo Utils
+
+
+ Copyright 2016 mvd
+
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in
+ compliance with the License. You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software distributed under the License is
+ distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and limitations under the License.
+
+*************************************************************************************************************/
+
+#include "systeminfo/cpu_features.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+#if defined( __x86_64__ ) || defined( __i386__ ) || defined( _M_X64 ) || defined( _M_IX86 )
+  #define LL_SYSTEMINFO_X86
+  #if defined( _MSC_VER )
+    #include <intrin.h>
+    #include <immintrin.h>
+  #else
+    #include <cpuid.h>
+  #endif
+#endif
+
+#if defined( __linux__ )
+  #include <sys/syscall.h>
+  #include <unistd.h>
+#endif
+
+
+namespace ll
+{
+namespace systeminfo
+{
+namespace platform
+{
+  namespace
+  {
+#if defined( LL_SYSTEMINFO_X86 )
+    using registers_t = std::array< std::uint32_t, 4 >;  // eax, ebx, ecx, edx
+
+    enum reg
+    {
+      eax,
+      ebx,
+      ecx,
+      edx
+    };
+
+    // xcr0 bits, see the intel sdm vol. 1, 13.3 "enabling the xsave feature set"
+    const std::uint64_t s_xcr0SSE = 1u << 1;
+    const std::uint64_t s_xcr0AVX = 1u << 2;
+    const std::uint64_t s_xcr0AVX512 = ( 1u << 5 ) | ( 1u << 6 ) | ( 1u << 7 );
+    const std::uint64_t s_xcr0AMX = ( 1u << 17 ) | ( 1u << 18 );
+
+
+    registers_t cpuid( std::uint32_t leaf_, std::uint32_t subleaf_ = 0 )
+    {
+      registers_t r = { { 0, 0, 0, 0 } };
+  #if defined( _MSC_VER )
+      std::array< int, 4 > values;
+      __cpuidex( values.data(), static_cast< int >( leaf_ ), static_cast< int >( subleaf_ ) );
+      std::memcpy( r.data(), values.data(), sizeof( r ) );
+  #else
+      __cpuid_count( leaf_, subleaf_, r[ eax ], r[ ebx ], r[ ecx ], r[ edx ] );
+  #endif
+      return r;
+    }
+
+
+    std::uint64_t xgetbv()
+    {
+  #if defined( _MSC_VER )
+      return _xgetbv( 0 );
+  #else
+      std::uint32_t low = 0, high = 0;
+      __asm__ __volatile__( "xgetbv" : "=a"( low ), "=d"( high ) : "c"( 0 ) );
+      return ( static_cast< std::uint64_t >( high ) << 32 ) | low;
+  #endif
+    }
+
+
+    // arch_prctl codes and the xfeature number of the tile data, see arch/x86/include/uapi/asm/prctl.h
+    const int s_archGetXcompPerm = 0x1022;
+    const int s_archReqXcompPerm = 0x1023;
+    const int s_xfeatureXtiledata = 18;
+
+
+    //! linux only hands out the amx tile state after the process asked for it, this only checks
+    bool amx_permitted()
+    {
+#if defined( __linux__ ) && defined( SYS_arch_prctl )
+      std::uint64_t permitted = 0;
+      if( ::syscall( SYS_arch_prctl, s_archGetXcompPerm, &permitted ) != 0 )
+        return false;
+      return ( permitted & ( std::uint64_t( 1 ) << s_xfeatureXtiledata ) ) != 0;
+#else
+      return true;
+#endif
+    }
+#endif
+
+
+    std::atomic< const isa_features* > s_features{ nullptr };
+    std::mutex s_featuresMutex;
+
+
+    isa_features detect_isa_features()
+    {
+      isa_features result;
+
+#if defined( LL_SYSTEMINFO_X86 )
+      auto set = [&result]( isa_feature f_, std::uint32_t register_, unsigned bit_ )
+      {
+        if( register_ & ( 1u << bit_ ) )
+          result.features.set( static_cast< size_t >( f_ ) );
+      };
+
+      auto leaf0 = cpuid( 0 );
+      auto maxLeaf = leaf0[ eax ];
+
+      char vendor[ 13 ] = { 0 };
+      std::memcpy( vendor, &leaf0[ ebx ], 4 );
+      std::memcpy( vendor + 4, &leaf0[ edx ], 4 );
+      std::memcpy( vendor + 8, &leaf0[ ecx ], 4 );
+      result.vendor = vendor;
+
+      if( maxLeaf < 1 )
+        return result;
+
+      auto leaf1 = cpuid( 1 );
+      set( isa_feature::sse, leaf1[ edx ], 25 );
+      set( isa_feature::sse2, leaf1[ edx ], 26 );
+      set( isa_feature::sse3, leaf1[ ecx ], 0 );
+      set( isa_feature::pclmulqdq, leaf1[ ecx ], 1 );
+      set( isa_feature::ssse3, leaf1[ ecx ], 9 );
+      set( isa_feature::sse4_1, leaf1[ ecx ], 19 );
+      set( isa_feature::sse4_2, leaf1[ ecx ], 20 );
+      set( isa_feature::movbe, leaf1[ ecx ], 22 );
+      set( isa_feature::popcnt, leaf1[ ecx ], 23 );
+      set( isa_feature::aes, leaf1[ ecx ], 25 );
+      set( isa_feature::rdrand, leaf1[ ecx ], 30 );
+
+      // the vector register state has to be enabled by the os, otherwise the instructions fault
+      bool osxsave = ( leaf1[ ecx ] & ( 1u << 27 ) ) != 0;
+      std::uint64_t xcr0 = osxsave ? xgetbv() : 0;
+      bool avxState = ( xcr0 & ( s_xcr0SSE | s_xcr0AVX ) ) == ( s_xcr0SSE | s_xcr0AVX );
+      bool avx512State = avxState && ( ( xcr0 & s_xcr0AVX512 ) == s_xcr0AVX512 );
+      bool amxState = ( xcr0 & s_xcr0AMX ) == s_xcr0AMX;
+
+      if( avxState )
+      {
+        set( isa_feature::avx, leaf1[ ecx ], 28 );
+        set( isa_feature::fma, leaf1[ ecx ], 12 );
+        set( isa_feature::f16c, leaf1[ ecx ], 29 );
+      }
+
+      auto extendedLeaf = cpuid( 0x80000000 );
+      if( extendedLeaf[ eax ] >= 0x80000001 )
+        set( isa_feature::lzcnt, cpuid( 0x80000001 )[ ecx ], 5 );
+
+      if( maxLeaf < 7 )
+        return result;
+
+      auto leaf7 = cpuid( 7, 0 );
+      set( isa_feature::bmi1, leaf7[ ebx ], 3 );
+      set( isa_feature::bmi2, leaf7[ ebx ], 8 );
+      set( isa_feature::rdseed, leaf7[ ebx ], 18 );
+      set( isa_feature::adx, leaf7[ ebx ], 19 );
+      set( isa_feature::sha, leaf7[ ebx ], 29 );
+      set( isa_feature::gfni, leaf7[ ecx ], 8 );
+
+      if( avxState )
+      {
+        set( isa_feature::avx2, leaf7[ ebx ], 5 );
+        set( isa_feature::vaes, leaf7[ ecx ], 9 );
+        set( isa_feature::vpclmulqdq, leaf7[ ecx ], 10 );
+      }
+
+      if( avx512State )
+      {
+        set( isa_feature::avx512f, leaf7[ ebx ], 16 );
+        set( isa_feature::avx512dq, leaf7[ ebx ], 17 );
+        set( isa_feature::avx512ifma, leaf7[ ebx ], 21 );
+        set( isa_feature::avx512cd, leaf7[ ebx ], 28 );
+        set( isa_feature::avx512bw, leaf7[ ebx ], 30 );
+        set( isa_feature::avx512vl, leaf7[ ebx ], 31 );
+        set( isa_feature::avx512vbmi, leaf7[ ecx ], 1 );
+        set( isa_feature::avx512vbmi2, leaf7[ ecx ], 6 );
+        set( isa_feature::avx512vnni, leaf7[ ecx ], 11 );
+        set( isa_feature::avx512bitalg, leaf7[ ecx ], 12 );
+        set( isa_feature::avx512vpopcntdq, leaf7[ ecx ], 14 );
+        set( isa_feature::avx512fp16, leaf7[ edx ], 23 );
+      }
+
+      bool hasAMX = ( leaf7[ edx ] & ( 1u << 24 ) ) != 0;
+      if( amxState && hasAMX && !amx_permitted() )
+        result.amxPermissionRequired = true;
+      else if( amxState && hasAMX )
+      {
+        set( isa_feature::amx_bf16, leaf7[ edx ], 22 );
+        set( isa_feature::amx_tile, leaf7[ edx ], 24 );
+        set( isa_feature::amx_int8, leaf7[ edx ], 25 );
+      }
+
+      if( leaf7[ eax ] >= 1 )
+      {
+        auto leaf7_1 = cpuid( 7, 1 );
+        if( avxState )
+          set( isa_feature::avx_vnni, leaf7_1[ eax ], 4 );
+        if( avx512State )
+          set( isa_feature::avx512bf16, leaf7_1[ eax ], 5 );
+      }
+#endif
+
+      return result;
+    }
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  const isa_features& get_isa_features()
+  {
+    auto features = s_features.load( std::memory_order_acquire );
+    if( features )
+      return *features;
+
+    std::lock_guard< std::mutex > lock( s_featuresMutex );
+    features = s_features.load( std::memory_order_relaxed );
+    if( !features )
+    {
+      // leaked, request_amx_permission() replaces it while references to it may still exist
+      features = new isa_features( detect_isa_features() );
+      s_features.store( features, std::memory_order_release );
+    }
+    return *features;
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  bool request_amx_permission()
+  {
+    if( !get_isa_features().amxPermissionRequired )
+      return get_isa_features().has( isa_feature::amx_tile );
+
+#if defined( LL_SYSTEMINFO_X86 ) && defined( __linux__ ) && defined( SYS_arch_prctl )
+    if( ::syscall( SYS_arch_prctl, s_archReqXcompPerm, s_xfeatureXtiledata ) != 0 )
+      return false;
+#endif
+
+    // another thread may have been granted the permission and published the features in the meantime
+    std::lock_guard< std::mutex > lock( s_featuresMutex );
+    if( s_features.load( std::memory_order_relaxed )->amxPermissionRequired )
+      s_features.store( new isa_features( detect_isa_features() ), std::memory_order_release );
+    return true;
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  bool has_isa_feature( isa_feature f_ )
+  {
+    return get_isa_features().has( f_ );
+  }
+
+} // namespace platform
+} // namespace systeminfo
+} // namespace ll
+
+
+
+namespace ll
+{
+  using namespace systeminfo;
+
+  std::string to_string( platform::isa_feature f_ )
+  {
+    static const std::array< const char*, static_cast< size_t >( platform::isa_feature::count ) > names = { {
+      "sse", "sse2", "sse3", "ssse3", "sse4.1", "sse4.2", "popcnt", "lzcnt", "movbe", "aes", "pclmulqdq",
+      "rdrand", "rdseed", "adx", "sha", "bmi1", "bmi2", "f16c", "fma", "avx", "avx2", "avx-vnni", "vaes",
+      "vpclmulqdq", "gfni", "avx512f", "avx512dq", "avx512cd", "avx512bw", "avx512vl", "avx512ifma",
+      "avx512vbmi", "avx512vbmi2", "avx512vnni", "avx512bitalg", "avx512vpopcntdq", "avx512bf16",
+      "avx512fp16", "amx-tile", "amx-int8", "amx-bf16"
+    } };
+
+    auto index = static_cast< size_t >( f_ );
+    return ( index < names.size() ) ? names[ index ] : "unknown";
+  }
+
+
+  std::string to_string( const platform::isa_features& f_ )
+  {
+    std::string result;
+    for( size_t i = 0; i < f_.features.size(); ++i )
+    {
+      if( !f_.features.test( i ) )
+        continue;
+
+      if( !result.empty() )
+        result += " ";
+      result += to_string( static_cast< platform::isa_feature >( i ) );
+    }
+    return result;
+  }
+
+} // namespace ll
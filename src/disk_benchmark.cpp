@@ -0,0 +1,189 @@
+/*************************************************************************************************************
+
+ Limelight Framework - SystemInfo Utils
+
+
+ Copyright 2016 mvd
+
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in
+ compliance with the License. You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software distributed under the License is
+ distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and limitations under the License.
+
+*************************************************************************************************************/
+
+#include "systeminfo/disk_benchmark.h"
+#include "systeminfo/exception.h"
+#include "storage_impl.h"
+
+#include <algorithm>
+
+
+namespace ll
+{
+namespace systeminfo
+{
+namespace storage
+{
+  namespace
+  {
+    benchmark_result make_test( 
+      benchmark_pattern pattern_, 
+      benchmark_engine engine_, 
+      unsigned blockSize_, 
+      unsigned queueDepth_ 
+    )
+    {
+      benchmark_result test;
+      test.pattern = pattern_;
+      test.engine = engine_;
+      test.blockSize = blockSize_;
+      test.queueDepth = std::max( queueDepth_, 1u );
+      return test;
+    }
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  double benchmark_result::bytes_per_second() const
+  {
+    return ( elapsed.count() > 0 ) 
+      ? static_cast< double >( bytes ) * 1e6 / static_cast< double >( elapsed.count() ) 
+      : 0.0;
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  double benchmark_result::operations_per_second() const
+  {
+    return ( elapsed.count() > 0 ) 
+      ? static_cast< double >( operations ) * 1e6 / static_cast< double >( elapsed.count() ) 
+      : 0.0;
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  const benchmark_result* benchmark_report::find( 
+    benchmark_pattern pattern_, 
+    benchmark_engine engine_, 
+    unsigned queueDepth_ 
+  ) const
+  {
+    auto it = std::find_if( results.begin(), results.end(), [&]( const benchmark_result& r_ ) 
+    { 
+      return ( r_.pattern == pattern_ ) && ( r_.engine == engine_ ) && ( r_.queueDepth == queueDepth_ ); 
+    } );
+
+    return ( it != results.end() ) ? &*it : nullptr;
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  benchmark_report run_disk_benchmark( 
+    const storage_info::volume& volume_, 
+    const benchmark_options& options_ 
+  )
+  {
+    benchmark_report report;
+    report.volume = volume_;
+    report.directory = options_.directory.empty() ? volume_.path : options_.directory;
+    report.started = std::chrono::system_clock::now();
+
+    auto blockSize = std::max( options_.sequentialBlockSize, options_.randomBlockSize );
+    if( report.directory.empty() || ( blockSize == 0 ) || ( options_.fileSizeInBytes < blockSize ) )
+      throw exception( error::invalid_parameter, "disk benchmark" );
+
+    // whole blocks only, so every request can be aligned
+    report.fileSizeInBytes = options_.fileSizeInBytes - options_.fileSizeInBytes % blockSize;
+
+    auto file = impl::create_benchmark_file( report.directory, report.fileSizeInBytes );
+    report.directIo = file->direct_io();
+    file->fill( options_.sequentialBlockSize );
+
+    std::vector< benchmark_result > tests;
+    for( auto engine : { benchmark_engine::sync, benchmark_engine::io_uring } )
+    {
+      if( !file->supports( engine ) || ( ( engine == benchmark_engine::io_uring ) && !options_.useIoUring ) )
+        continue;
+
+      auto sequentialBlockSize = options_.sequentialBlockSize;
+      auto sequentialQueueDepth = options_.sequentialQueueDepth;
+      tests.push_back( 
+        make_test( benchmark_pattern::sequential_write, engine, sequentialBlockSize, sequentialQueueDepth ) 
+      );
+      tests.push_back( 
+        make_test( benchmark_pattern::sequential_read, engine, sequentialBlockSize, sequentialQueueDepth ) 
+      );
+
+      for( auto depth : options_.randomQueueDepths )
+        tests.push_back( make_test( benchmark_pattern::random_read, engine, options_.randomBlockSize, depth ) );
+    }
+
+    // reused, a fast device completes millions of requests per test
+    std::vector< std::uint32_t > latencies;
+    for( auto& test : tests )
+    {
+      latencies.clear();
+
+      auto start = std::chrono::steady_clock::now();
+      file->run( test, start + options_.duration, latencies );
+      auto stop = std::chrono::steady_clock::now();
+
+      test.operations = latencies.size();
+      test.bytes = test.operations * test.blockSize;
+      test.elapsed = std::chrono::duration_cast< std::chrono::microseconds >( stop - start );
+      test.latency = impl::summarize_latencies( latencies );
+      report.results.push_back( test );
+    }
+
+    return report;
+  }
+
+}  // namespace storage
+}  // namespace systeminfo
+}  // namespace ll
+
+
+
+namespace ll
+{
+  using namespace systeminfo;
+
+  std::string to_string( storage::benchmark_pattern p_ )
+  {
+    switch ( p_ )
+    {
+    case storage::benchmark_pattern::sequential_write:
+      return "Sequential Write";
+    case storage::benchmark_pattern::sequential_read:
+      return "Sequential Read";
+    case storage::benchmark_pattern::random_read:
+      return "Random Read";
+    default:
+      return "Unknown";
+    }
+  }
+
+
+  std::string to_string( storage::benchmark_engine e_ )
+  {
+    switch ( e_ )
+    {
+    case storage::benchmark_engine::sync:
+      return "Sync";
+    case storage::benchmark_engine::io_uring:
+      return "io_uring";
+    default:
+      return "Unknown";
+    }
+  }
+
+} // namespace ll
@@ -35,6 +35,9 @@ namespace systeminfo
         case error::invalid_parameter:
           result += "Invalid parameter";
           break;
+        case error::invalid_request:
+          result += "Invalid request";
+          break;
         case error::internal:
           result += "Internal error";
         default:
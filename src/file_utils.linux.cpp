@@ -0,0 +1,377 @@
+/*************************************************************************************************************
+
+ Limelight Framework - SystemInfo Utils
+
+
+ Copyright 2016 mvd
+
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in
+ compliance with the License. You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software distributed under the License is
+ distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and limitations under the License.
+
+*************************************************************************************************************/
+
+#include "file_utils.linux.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+
+namespace ll
+{
+namespace systeminfo
+{
+namespace detail
+{
+  namespace
+  {
+    const size_t s_initialBufferSize = 4096;
+
+    bool is_blank( char c_ )
+    {
+      return ( c_ == ' ' ) || ( c_ == '\t' ) || ( c_ == '\n' ) || ( c_ == '\r' );
+    }
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  proc_file::proc_file( const std::string& path_ )
+  {
+    open( path_ );
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  proc_file::~proc_file()
+  {
+    close();
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  proc_file::proc_file( proc_file&& other_ )
+    : m_fd( other_.m_fd ), m_buffer( std::move( other_.m_buffer ) ), m_size( other_.m_size )
+  {
+    other_.m_fd = -1;
+    other_.m_buffer.assign( 1, '\0' );
+    other_.m_size = 0;
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  proc_file& proc_file::operator=( proc_file&& other_ )
+  {
+    if( this != &other_ )
+    {
+      close();
+      std::swap( m_fd, other_.m_fd );
+      std::swap( m_buffer, other_.m_buffer );
+      std::swap( m_size, other_.m_size );
+    }
+    return *this;
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  bool proc_file::open( const std::string& path_ )
+  {
+    close();
+
+    do
+    {
+      m_fd = ::open( path_.c_str(), O_RDONLY | O_CLOEXEC );
+    } while( ( m_fd < 0 ) && ( errno == EINTR ) );
+
+    return m_fd >= 0;
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  void proc_file::close()
+  {
+    if( m_fd >= 0 )
+      ::close( m_fd );
+
+    m_fd = -1;
+    m_size = 0;
+    m_buffer[ 0 ] = '\0';
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  bool proc_file::read()
+  {
+    m_size = 0;
+    m_buffer[ 0 ] = '\0';
+
+    if( m_fd < 0 )
+      return false;
+
+    if( m_buffer.size() < s_initialBufferSize )
+      m_buffer.resize( s_initialBufferSize );
+
+    for( ;; )
+    {
+      // keep one byte for the terminating zero
+      if( m_size + 1 >= m_buffer.size() )
+        m_buffer.resize( m_buffer.size() * 2 );
+
+      auto count = ::pread(
+        m_fd, m_buffer.data() + m_size, m_buffer.size() - m_size - 1, static_cast< off_t >( m_size )
+      );
+
+      if( count < 0 )
+      {
+        if( errno == EINTR )
+          continue;
+
+        m_size = 0;
+        m_buffer[ 0 ] = '\0';
+        return false;
+      }
+
+      if( count == 0 )
+        break;
+
+      m_size += static_cast< size_t >( count );
+    }
+
+    m_buffer[ m_size ] = '\0';
+    return true;
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  bool proc_file::read_once()
+  {
+    m_size = 0;
+    m_buffer[ 0 ] = '\0';
+
+    if( m_fd < 0 )
+      return false;
+
+    if( m_buffer.size() < s_initialBufferSize )
+      m_buffer.resize( s_initialBufferSize );
+
+    ssize_t count = 0;
+    do
+    {
+      count = ::pread( m_fd, m_buffer.data(), m_buffer.size() - 1, 0 );
+    } while( ( count < 0 ) && ( errno == EINTR ) );
+
+    if( count < 0 )
+      return false;
+
+    // the content might not be complete
+    if( static_cast< size_t >( count ) == m_buffer.size() - 1 )
+      return read();
+
+    m_size = static_cast< size_t >( count );
+    m_buffer[ m_size ] = '\0';
+    return true;
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  bool read_file( const std::string& path_, std::string& content_ )
+  {
+    content_.clear();
+
+    proc_file file( path_ );
+    if( !file.read() )
+      return false;
+
+    content_.assign( file.data(), file.size() );
+    return true;
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  std::string read_line( const std::string& path_ )
+  {
+    std::string content;
+    if( !read_file( path_, content ) )
+      return std::string();
+
+    auto last = content.find( '\n' );
+    if( last != std::string::npos )
+      content.resize( last );
+
+    while( !content.empty() && is_blank( content.back() ) )
+      content.pop_back();
+
+    auto first = std::find_if( content.begin(), content.end(), []( char c_ ) { return !is_blank( c_ ); } );
+    return std::string( first, content.end() );
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  bool try_read_uint( const std::string& path_, std::uint64_t& value_ )
+  {
+    proc_file file( path_ );
+    if( !file.read() )
+      return false;
+
+    const char* p = file.data();
+    while( ( p != file.end() ) && is_blank( *p ) )
+      ++p;
+
+    if( ( p == file.end() ) || ( *p < '0' ) || ( *p > '9' ) )
+      return false;
+
+    value_ = parse_uint( p, file.end() );
+    return true;
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  std::uint64_t read_uint( const std::string& path_, std::uint64_t default_ )
+  {
+    std::uint64_t value = 0;
+    return try_read_uint( path_, value ) ? value : default_;
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  std::uint64_t parse_uint( const char*& p_, const char* end_ )
+  {
+    while( ( p_ != end_ ) && ( ( *p_ == ' ' ) || ( *p_ == '\t' ) ) )
+      ++p_;
+
+    std::uint64_t value = 0;
+    while( ( p_ != end_ ) && ( *p_ >= '0' ) && ( *p_ <= '9' ) )
+      value = value * 10 + static_cast< std::uint64_t >( *p_++ - '0' );
+
+    return value;
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  void skip_line( const char*& p_, const char* end_ )
+  {
+    while( ( p_ != end_ ) && ( *p_ != '\n' ) )
+      ++p_;
+
+    if( p_ != end_ )
+      ++p_;
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  std::vector< unsigned > parse_cpu_list( const char* p_, const char* end_ )
+  {
+    std::vector< unsigned > cpus;
+
+    while( p_ != end_ )
+    {
+      if( ( *p_ < '0' ) || ( *p_ > '9' ) )
+      {
+        ++p_;
+        continue;
+      }
+
+      auto first = static_cast< unsigned >( parse_uint( p_, end_ ) );
+      auto last = first;
+      if( ( p_ != end_ ) && ( *p_ == '-' ) )
+      {
+        ++p_;
+        last = static_cast< unsigned >( parse_uint( p_, end_ ) );
+      }
+
+      for( auto cpu = first; cpu <= last; ++cpu )
+        cpus.push_back( cpu );
+    }
+
+    return cpus;
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  std::vector< unsigned > parse_cpu_list( const std::string& list_ )
+  {
+    return parse_cpu_list( list_.data(), list_.data() + list_.size() );
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  std::vector< std::string > list_directory( const std::string& directory_ )
+  {
+    std::vector< std::string > result;
+
+    DIR* dir = ::opendir( directory_.c_str() );
+    if( !dir )
+      return result;
+
+    while( struct dirent* entry = ::readdir( dir ) )
+    {
+      if( ( std::strcmp( entry->d_name, "." ) != 0 ) && ( std::strcmp( entry->d_name, ".." ) != 0 ) )
+        result.push_back( entry->d_name );
+    }
+
+    ::closedir( dir );
+
+    std::sort( result.begin(), result.end() );
+    return result;
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  std::vector< unsigned > list_numbered_entries( const std::string& directory_, const std::string& prefix_ )
+  {
+    std::vector< unsigned > result;
+
+    DIR* dir = ::opendir( directory_.c_str() );
+    if( !dir )
+      return result;
+
+    while( struct dirent* entry = ::readdir( dir ) )
+    {
+      const char* name = entry->d_name;
+      if( std::strncmp( name, prefix_.c_str(), prefix_.size() ) != 0 )
+        continue;
+
+      const char* p = name + prefix_.size();
+      const char* end = p + std::strlen( p );
+      if( ( p == end ) || !std::all_of( p, end, []( char c_ ) { return ( c_ >= '0' ) && ( c_ <= '9' ); } ) )
+        continue;
+
+      result.push_back( static_cast< unsigned >( parse_uint( p, end ) ) );
+    }
+
+    ::closedir( dir );
+
+    std::sort( result.begin(), result.end() );
+    return result;
+  }
+
+}  // namespace detail
+}  // namespace systeminfo
+}  // namespace ll
@@ -0,0 +1,111 @@
+/*************************************************************************************************************
+
+ Limelight Framework - SystemInfo Utils
+
+
+ Copyright 2016 mvd
+
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in
+ compliance with the License. You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software distributed under the License is
+ distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and limitations under the License.
+
+*************************************************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+
+namespace ll
+{
+namespace systeminfo
+{
+namespace detail
+{
+  // ---------------------------------------------------------------------------------------------------------
+  // Types
+  // ---------------------------------------------------------------------------------------------------------
+
+  //! a file in /proc or /sys that is opened once and re-read with pread into a reusable buffer
+  class proc_file
+  {
+  public:
+    proc_file() = default;
+    explicit proc_file( const std::string& path_ );
+    ~proc_file();
+
+    proc_file( proc_file&& other_ );
+    proc_file& operator=( proc_file&& other_ );
+
+    proc_file( const proc_file& ) = delete;
+    proc_file& operator=( const proc_file& ) = delete;
+
+    bool open( const std::string& path_ );
+    void close();
+
+    bool is_open() const { return m_fd >= 0; }
+    int  fd() const { return m_fd; }
+
+    //! re-reads the complete file, the buffer only grows if the content doesn't fit
+    bool read();
+
+    //! a single pread for small files that are generated in one go, e.g. /proc/<pid>/stat, which saves the
+    //! second read that only detects the end of the file; falls back to read() if the buffer is filled
+    bool read_once();
+
+    //! the content of the last read, always zero-terminated
+    const char* data() const { return m_buffer.data(); }
+    const char* end() const { return m_buffer.data() + m_size; }
+    size_t size() const { return m_size; }
+
+  private:
+    int m_fd = -1;
+    std::vector< char > m_buffer = std::vector< char >( 1, '\0' );
+    size_t m_size = 0;
+  };
+
+
+  // ---------------------------------------------------------------------------------------------------------
+  // Functions
+  // ---------------------------------------------------------------------------------------------------------
+
+  //! reads a (small) file without spawning a process, returns false if it can't be read
+  bool read_file( const std::string& path_, std::string& content_ );
+
+  //! reads the first line of a file, trimmed; empty if the file doesn't exist
+  std::string read_line( const std::string& path_ );
+
+  //! reads a single unsigned value from a file, e.g. a sysfs attribute
+  bool try_read_uint( const std::string& path_, std::uint64_t& value_ );
+
+  std::uint64_t read_uint( const std::string& path_, std::uint64_t default_ = 0 );
+
+
+  //! parses a decimal number starting at p_ (leading blanks are skipped), advances p_ behind it
+  std::uint64_t parse_uint( const char*& p_, const char* end_ );
+
+  //! moves p_ to the beginning of the next line
+  void skip_line( const char*& p_, const char* end_ );
+
+  //! parses a kernel cpu list such as "0-3,8,10-11"
+  std::vector< unsigned > parse_cpu_list( const char* p_, const char* end_ );
+
+  std::vector< unsigned > parse_cpu_list( const std::string& list_ );
+
+  //! the names of the entries of a directory without "." and "..", sorted; empty if it can't be read
+  std::vector< std::string > list_directory( const std::string& directory_ );
+
+  //! lists the numeric suffixes of the directory entries starting with prefix_, e.g. cpu0, cpu1 ...
+  std::vector< unsigned > list_numbered_entries( const std::string& directory_, const std::string& prefix_ );
+
+}  // namespace detail
+}  // namespace systeminfo
+}  // namespace ll
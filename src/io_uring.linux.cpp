@@ -0,0 +1,187 @@
+/*************************************************************************************************************
+
+ Limelight Framework - SystemInfo Utils
+
+
+ Copyright 2016 mvd
+
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in
+ compliance with the License. You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software distributed under the License is
+ distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and limitations under the License.
+
+*************************************************************************************************************/
+
+#include "io_uring.linux.h"
+
+#if defined( LL_SYSTEMINFO_IO_URING )
+
+#include <cerrno>
+#include <cstring>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+
+namespace ll
+{
+namespace systeminfo
+{
+namespace detail
+{
+  namespace
+  {
+    void* map_ring( int fd_, size_t size_, off_t offset_ )
+    {
+      auto p = ::mmap( nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, offset_ );
+      return ( p != MAP_FAILED ) ? p : nullptr;
+    }
+
+
+    template< typename T >
+    T* at( void* ring_, unsigned offset_ )
+    {
+      return reinterpret_cast< T* >( static_cast< char* >( ring_ ) + offset_ );
+    }
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  io_ring::io_ring( unsigned entries_ )
+  {
+    io_uring_params params;
+    std::memset( &params, 0, sizeof( params ) );
+
+    m_fd = static_cast< int >( ::syscall( __NR_io_uring_setup, entries_, &params ) );
+    if( m_fd < 0 )
+    {
+      m_fd = -1;
+      return;
+    }
+
+    // the kernel rounds the number of entries up to a power of two
+    m_sqEntries = params.sq_entries;
+    m_sqRingSize = params.sq_off.array + params.sq_entries * sizeof( unsigned );
+    m_cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof( io_uring_cqe );
+    m_sqesSize = params.sq_entries * sizeof( io_uring_sqe );
+
+    m_sqRing = map_ring( m_fd, m_sqRingSize, IORING_OFF_SQ_RING );
+    m_cqRing = map_ring( m_fd, m_cqRingSize, IORING_OFF_CQ_RING );
+    m_sqes = static_cast< io_uring_sqe* >( map_ring( m_fd, m_sqesSize, IORING_OFF_SQES ) );
+    if( !m_sqRing || !m_cqRing || !m_sqes )
+    {
+      close();
+      return;
+    }
+
+    m_sqHead = at< unsigned >( m_sqRing, params.sq_off.head );
+    m_sqTail = at< unsigned >( m_sqRing, params.sq_off.tail );
+    m_sqMask = *at< unsigned >( m_sqRing, params.sq_off.ring_mask );
+    m_sqArray = at< unsigned >( m_sqRing, params.sq_off.array );
+    m_sqLocalTail = *m_sqTail;
+    m_sqSubmitted = m_sqLocalTail;
+
+    m_cqHead = at< unsigned >( m_cqRing, params.cq_off.head );
+    m_cqTail = at< unsigned >( m_cqRing, params.cq_off.tail );
+    m_cqMask = *at< unsigned >( m_cqRing, params.cq_off.ring_mask );
+    m_cqes = at< io_uring_cqe >( m_cqRing, params.cq_off.cqes );
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  io_ring::~io_ring()
+  {
+    close();
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  void io_ring::close()
+  {
+    if( m_sqes )
+      ::munmap( m_sqes, m_sqesSize );
+    if( m_cqRing )
+      ::munmap( m_cqRing, m_cqRingSize );
+    if( m_sqRing )
+      ::munmap( m_sqRing, m_sqRingSize );
+    if( m_fd >= 0 )
+      ::close( m_fd );
+
+    m_fd = -1;
+    m_sqes = nullptr;
+    m_cqRing = nullptr;
+    m_sqRing = nullptr;
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  io_uring_sqe* io_ring::get_sqe()
+  {
+    if( !is_open() || ( m_sqLocalTail - __atomic_load_n( m_sqHead, __ATOMIC_ACQUIRE ) >= m_sqEntries ) )
+      return nullptr;
+
+    auto index = m_sqLocalTail & m_sqMask;
+    m_sqArray[ index ] = index;
+    ++m_sqLocalTail;
+
+    auto sqe = &m_sqes[ index ];
+    std::memset( sqe, 0, sizeof( *sqe ) );
+    return sqe;
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  int io_ring::submit( unsigned wait_ )
+  {
+    if( !is_open() )
+      return -EBADF;
+
+    __atomic_store_n( m_sqTail, m_sqLocalTail, __ATOMIC_RELEASE );
+
+    auto pending = m_sqLocalTail - m_sqSubmitted;
+    auto flags = ( wait_ > 0 ) ? IORING_ENTER_GETEVENTS : 0u;
+    auto result = ::syscall( __NR_io_uring_enter, m_fd, pending, wait_, flags, nullptr, 0 );
+    if( result < 0 )
+      return -errno;
+
+    m_sqSubmitted += static_cast< unsigned >( result );
+    return static_cast< int >( result );
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  const io_uring_cqe* io_ring::peek() const
+  {
+    if( !is_open() )
+      return nullptr;
+
+    auto head = *m_cqHead;
+    if( head == __atomic_load_n( m_cqTail, __ATOMIC_ACQUIRE ) )
+      return nullptr;
+
+    return &m_cqes[ head & m_cqMask ];
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  void io_ring::pop()
+  {
+    __atomic_store_n( m_cqHead, *m_cqHead + 1, __ATOMIC_RELEASE );
+  }
+
+}  // namespace detail
+}  // namespace systeminfo
+}  // namespace ll
+
+#endif
@@ -0,0 +1,104 @@
+/*************************************************************************************************************
+
+ Limelight Framework - SystemInfo Utils
+
+
+ Copyright 2016 mvd
+
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in
+ compliance with the License. You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software distributed under the License is
+ distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and limitations under the License.
+
+*************************************************************************************************************/
+
+#pragma once
+
+#if defined( __has_include )
+  #if __has_include( <linux/io_uring.h> )
+    #include <linux/io_uring.h>
+    #include <sys/syscall.h>
+    #if defined( __NR_io_uring_setup )
+      #define LL_SYSTEMINFO_IO_URING
+    #endif
+  #endif
+#endif
+
+#if defined( LL_SYSTEMINFO_IO_URING )
+
+#include <cstddef>
+
+
+namespace ll
+{
+namespace systeminfo
+{
+namespace detail
+{
+  // ---------------------------------------------------------------------------------------------------------
+  // Types
+  // ---------------------------------------------------------------------------------------------------------
+
+  //! a single submission and completion queue on top of the raw system calls, so there's no dependency on
+  //! liburing; the ring is used by one thread at a time
+  class io_ring
+  {
+  public:
+    //! is_open() is false if io_uring is not available, e.g. disabled by kernel.io_uring_disabled or seccomp
+    explicit io_ring( unsigned entries_ );
+    ~io_ring();
+
+    io_ring( const io_ring& ) = delete;
+    io_ring& operator=( const io_ring& ) = delete;
+
+    bool is_open() const { return m_fd >= 0; }
+    unsigned entries() const { return m_sqEntries; }
+
+    //! the next free submission entry, zeroed; nullptr if all entries are queued and not yet submitted
+    io_uring_sqe* get_sqe();
+
+    //! submits the queued entries and waits until at least wait_ completions are available; returns the
+    //! number of submitted entries or -errno
+    int submit( unsigned wait_ = 0 );
+
+    //! the oldest completion that hasn't been consumed yet, nullptr if there's none
+    const io_uring_cqe* peek() const;
+
+    //! consumes the completion returned by peek()
+    void pop();
+
+  private:
+    void close();
+
+    int m_fd = -1;
+    unsigned m_sqEntries = 0;
+
+    void* m_sqRing = nullptr;
+    size_t m_sqRingSize = 0;
+    void* m_cqRing = nullptr;
+    size_t m_cqRingSize = 0;
+    io_uring_sqe* m_sqes = nullptr;
+    size_t m_sqesSize = 0;
+
+    unsigned* m_sqHead = nullptr;
+    unsigned* m_sqTail = nullptr;
+    unsigned m_sqMask = 0;
+    unsigned* m_sqArray = nullptr;
+    unsigned m_sqLocalTail = 0;  // includes the entries that were handed out but not yet submitted
+    unsigned m_sqSubmitted = 0;
+
+    unsigned* m_cqHead = nullptr;
+    unsigned* m_cqTail = nullptr;
+    unsigned m_cqMask = 0;
+    io_uring_cqe* m_cqes = nullptr;
+  };
+
+}  // namespace detail
+}  // namespace systeminfo
+}  // namespace ll
+
+#endif
@@ -18,9 +18,15 @@
 
 #include "systeminfo/platform.h"
 #include "platform_impl.h"
+#include "systeminfo/exception.h"
 
 #include <base/environment.h>
 
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <iterator>
+
 
 namespace ll
 {
@@ -42,6 +48,106 @@ namespace platform
   }
 
 
+  namespace
+  {
+    cpu_info::logical_core* find_logical_core( cpu_info& info_, unsigned id_ )
+    {
+      for( auto& p : info_.processorPacks )
+      {
+        for( auto& c : p.physicalCores )
+        {
+          for( auto& l : c.logicalCores )
+          {
+            if( l.id == id_ )
+              return &l;
+          }
+        }
+      }
+      return nullptr;
+    }
+
+
+    void link_caches( cpu_info& info_ )
+    {
+      std::stable_sort(
+        info_.caches.begin(),
+        info_.caches.end(),
+        []( const cpu_info::cache& lhs_, const cpu_info::cache& rhs_ ) { return lhs_.level < rhs_.level; }
+      );
+
+      for( auto& p : info_.processorPacks )
+      {
+        for( auto& c : p.physicalCores )
+        {
+          for( auto& l : c.logicalCores )
+            l.caches.clear();
+        }
+      }
+
+      for( size_t i = 0; i < info_.caches.size(); ++i )
+      {
+        for( auto id : info_.caches[ i ].logicalCores )
+        {
+          if( auto core = find_logical_core( info_, id ) )
+            core->caches.push_back( i );
+        }
+      }
+    }
+
+
+    bool holds_data( cache_type t_ )
+    {
+      return ( t_ == cache_type::data ) || ( t_ == cache_type::unified );
+    }
+
+
+    std::uint64_t delta( std::uint64_t previous_, std::uint64_t current_ )
+    {
+      // counters can go backwards if a cpu has been taken offline in between
+      return ( current_ > previous_ ) ? current_ - previous_ : 0;
+    }
+
+
+    void compute_load(
+      const cpu_times::logical_core& previous_,
+      const cpu_times::logical_core& current_,
+      cpu_load::logical_core& load_
+    )
+    {
+      auto user = delta( previous_.user, current_.user );
+      auto nice = delta( previous_.nice, current_.nice );
+      auto system = delta( previous_.system, current_.system );
+      auto idle = delta( previous_.idle, current_.idle );
+      auto iowait = delta( previous_.iowait, current_.iowait );
+      auto irq = delta( previous_.irq, current_.irq );
+      auto softirq = delta( previous_.softirq, current_.softirq );
+      auto steal = delta( previous_.steal, current_.steal );
+
+      auto total = user + nice + system + idle + iowait + irq + softirq + steal;
+      if( total == 0 )
+      {
+        load_ = cpu_load::logical_core();
+        return;
+      }
+
+      auto percent = [total]( std::uint64_t ticks_ ) 
+      { 
+        return 100.0 * static_cast< double >( ticks_ ) / static_cast< double >( total ); 
+      };
+
+      load_.userPercent = percent( user );
+      load_.nicePercent = percent( nice );
+      load_.systemPercent = percent( system );
+      load_.idlePercent = percent( idle );
+      load_.iowaitPercent = percent( iowait );
+      load_.irqPercent = percent( irq );
+      load_.softirqPercent = percent( softirq );
+      load_.stealPercent = percent( steal );
+      load_.busyPercent = percent( total - idle - iowait );
+    }
+  }
+
+
   // ---------------------------------------------------------------------------------------------------------
 
   std::string get_device_manufacturer()
@@ -85,6 +191,8 @@ namespace platform
 
       for( auto& p : state::s_cpuInfo.processorPacks )
         p.name = impl::get_processor_name();
+
+      link_caches( state::s_cpuInfo );
         
       state::s_cpuInfoRetrieved = true;      
     }
@@ -94,6 +202,232 @@ namespace platform
   }
   
 
+  // ---------------------------------------------------------------------------------------------------------
+
+  void update_cpu_info( cpu_info& info_ )
+  {
+    impl::get_dynamic_cpu_info( info_ );
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  cpu_budget get_cpu_budget()
+  {
+    auto budget = impl::get_cpu_budget();
+
+    if( budget.allowedLogicalCores.empty() )
+    {
+      for( const auto& p : get_cpu_info().processorPacks )
+      {
+        for( const auto& c : p.physicalCores )
+        {
+          for( const auto& l : c.logicalCores )
+            budget.allowedLogicalCores.push_back( l.id );
+        }
+      }
+      std::sort( budget.allowedLogicalCores.begin(), budget.allowedLogicalCores.end() );
+    }
+
+    budget.logicalCores = static_cast< double >( budget.allowedLogicalCores.size() );
+    if( ( budget.quotaInMicroseconds > 0 ) && ( budget.periodInMicroseconds > 0 ) )
+    {
+      auto quota = static_cast< double >( budget.quotaInMicroseconds ) / budget.periodInMicroseconds;
+      budget.logicalCores = std::min( budget.logicalCores, quota );
+    }
+
+    return budget;
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  void get_cpu_times( cpu_times& times_ )
+  {
+    impl::get_cpu_times( times_ );
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  void get_cpu_load( const cpu_times& previous_, const cpu_times& current_, cpu_load& load_ )
+  {
+    load_.logicalCores.resize( current_.logicalCores.size() );
+
+    compute_load( previous_.total, current_.total, load_.total );
+    for( size_t i = 0; i < current_.logicalCores.size(); ++i )
+    {
+      if( i < previous_.logicalCores.size() )
+        compute_load( previous_.logicalCores[ i ], current_.logicalCores[ i ], load_.logicalCores[ i ] );
+      else
+        load_.logicalCores[ i ] = cpu_load::logical_core();
+    }
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  numa_info get_numa_info()
+  {
+    auto info = impl::get_numa_info();
+    if( !info.nodes.empty() )
+      return info;
+
+    // no numa information available, treat the machine as a single node
+    auto cpu = get_cpu_info();
+    auto memory = get_memory_info();
+
+    info.nodes.resize( 1 );
+    auto& node = info.nodes.back();
+    node.totalMemoryInBytes = memory.totalPhysicalMemoryInBytes;
+    node.freeMemoryInBytes = memory.freePhysicalMemoryInBytes;
+    node.distances.push_back( 10 );
+    for( const auto& p : cpu.processorPacks )
+    {
+      node.processorPacks.push_back( p.id );
+      for( const auto& c : p.physicalCores )
+      {
+        for( const auto& l : c.logicalCores )
+          node.logicalCores.push_back( l.id );
+      }
+    }
+
+    return info;
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  hugepage_info get_hugepage_info()
+  {
+    auto info = impl::get_hugepage_info();
+
+    std::sort(
+      info.pools.begin(),
+      info.pools.end(),
+      []( const hugepage_info::pool& lhs_, const hugepage_info::pool& rhs_ ) 
+      { 
+        return lhs_.pageSizeInBytes < rhs_.pageSizeInBytes; 
+      }
+    );
+
+    return info;
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  const std::vector< std::uint64_t >& get_page_sizes()
+  {
+    static const std::vector< std::uint64_t > s_pageSizes = []()
+    {
+      auto sizes = impl::get_page_sizes();
+      std::sort( sizes.begin(), sizes.end() );
+      sizes.erase( std::unique( sizes.begin(), sizes.end() ), sizes.end() );
+      return sizes;
+    }();
+
+    return s_pageSizes;
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  pressure_info get_pressure_info( pressure_resource resource_, pressure_scope scope_ )
+  {
+    pressure_info info;
+    if( !impl::get_pressure_info( resource_, scope_, info ) )
+      throw exception( error::invalid_request, "psi " + ll::to_string( resource_ ) );
+
+    return info;
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  pressure_trigger::pressure_trigger(
+    pressure_resource resource_,
+    pressure_stall stall_,
+    std::chrono::microseconds threshold_,
+    std::chrono::microseconds window_,
+    pressure_scope scope_
+  )
+  {
+    if( ( threshold_.count() <= 0 ) || ( window_ < threshold_ ) )
+      throw exception( error::invalid_parameter, "pressure trigger threshold" );
+
+    m_handle = impl::open_pressure_trigger( 
+      resource_, 
+      stall_, 
+      static_cast< std::uint64_t >( threshold_.count() ), 
+      static_cast< std::uint64_t >( window_.count() ), 
+      scope_ 
+    );
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  pressure_trigger::~pressure_trigger()
+  {
+    if( m_handle >= 0 )
+      impl::close_pressure_trigger( m_handle );
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  pressure_trigger::pressure_trigger( pressure_trigger&& other_ ) 
+    : m_handle( other_.m_handle )
+  {
+    other_.m_handle = -1;
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  pressure_trigger& pressure_trigger::operator=( pressure_trigger&& other_ )
+  {
+    std::swap( m_handle, other_.m_handle );
+    return *this;
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  bool pressure_trigger::wait( std::chrono::milliseconds timeout_ )
+  {
+    std::vector< pressure_trigger* > triggers( 1, this );
+    return !wait_for_pressure( triggers, timeout_ ).empty();
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  std::vector< size_t > wait_for_pressure( 
+    const std::vector< pressure_trigger* >& triggers_, 
+    std::chrono::milliseconds timeout_ 
+  )
+  {
+    std::vector< int > handles;
+    handles.reserve( triggers_.size() );
+    for( auto t : triggers_ )
+    {
+      if( !t || ( t->native_handle() < 0 ) )
+        throw exception( error::invalid_parameter, "pressure trigger" );
+      handles.push_back( t->native_handle() );
+    }
+
+    std::vector< size_t > fired;
+    auto timeout = -1;
+    if( timeout_.count() >= 0 )
+      timeout = static_cast< int >( std::min< long long >( timeout_.count(), INT_MAX ) );
+
+    impl::wait_for_pressure( handles, timeout, fired );
+    return fired;
+  }
+
+
   // ---------------------------------------------------------------------------------------------------------
 
   gpu_info get_gpu_info()
@@ -141,6 +475,112 @@ namespace platform
     );
   }
 
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  size_t get_effective_core_count( const platform::cpu_budget& budget_ )
+  {
+    auto count = static_cast< size_t >( std::ceil( budget_.logicalCores ) );
+    return std::max( count, size_t( 1 ) );
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  cpu_info restrict_cpu_info( const platform::cpu_info& cpu_, const std::vector< unsigned >& logicalCores_ )
+  {
+    auto allowed = [&logicalCores_]( unsigned id_ )
+    {
+      return std::find( logicalCores_.begin(), logicalCores_.end(), id_ ) != logicalCores_.end();
+    };
+
+    cpu_info result;
+    for( const auto& p : cpu_.processorPacks )
+    {
+      auto pack = p;
+      pack.physicalCores.clear();
+      for( const auto& c : p.physicalCores )
+      {
+        auto core = c;
+        core.logicalCores.clear();
+        for( const auto& l : c.logicalCores )
+        {
+          if( allowed( l.id ) )
+            core.logicalCores.push_back( l );
+        }
+
+        if( !core.logicalCores.empty() )
+          pack.physicalCores.push_back( core );
+      }
+
+      if( !pack.physicalCores.empty() )
+        result.processorPacks.push_back( pack );
+    }
+
+    for( const auto& c : cpu_.caches )
+    {
+      auto cache = c;
+      cache.logicalCores.clear();
+      auto& cores = cache.logicalCores;
+      std::copy_if( c.logicalCores.begin(), c.logicalCores.end(), std::back_inserter( cores ), allowed );
+
+      if( !cache.logicalCores.empty() )
+        result.caches.push_back( cache );
+    }
+
+    // the cache indices of the logical cores are stale after removing caches
+    link_caches( result );
+    return result;
+  }
+
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  const cpu_info::cache* find_cache( const platform::cpu_info& cpu_, unsigned logicalCoreID_, unsigned level_ )
+  {
+    for( const auto& c : cpu_.caches )
+    {
+      if( ( c.level != level_ ) || !holds_data( c.type ) )
+        continue;
+
+      if( std::find( c.logicalCores.begin(), c.logicalCores.end(), logicalCoreID_ ) != c.logicalCores.end() )
+        return &c;
+    }
+    return nullptr;
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  std::uint64_t get_cache_size_per_logical_core( const platform::cpu_info& cpu_, unsigned level_ )
+  {
+    std::uint64_t size = 0;
+    for( const auto& c : cpu_.caches )
+    {
+      if( ( c.level != level_ ) || !holds_data( c.type ) || c.logicalCores.empty() )
+        continue;
+
+      auto share = c.sizeInBytes / c.logicalCores.size();
+      if( ( size == 0 ) || ( share < size ) )
+        size = share;
+    }
+    return size;
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  std::vector< unsigned > get_cores_sharing_cache( 
+    const platform::cpu_info& cpu_, 
+    unsigned logicalCoreID_, 
+    unsigned level_ 
+  )
+  {
+    auto cache = find_cache( cpu_, logicalCoreID_, level_ );
+    return cache ? cache->logicalCores : std::vector< unsigned >();
+  }
+
 } // namespace platform
 } // namespace systeminfo
 } // namespace ll
@@ -166,5 +606,57 @@ namespace ll
     }
   }
 
+
+  std::string to_string( platform::transparent_hugepage_mode m_ )
+  {
+    switch ( m_ )
+    {
+    case platform::transparent_hugepage_mode::always:
+      return "always";
+    case platform::transparent_hugepage_mode::madvise:
+      return "madvise";
+    case platform::transparent_hugepage_mode::never:
+      return "never";
+    case platform::transparent_hugepage_mode::defer:
+      return "defer";
+    case platform::transparent_hugepage_mode::defer_madvise:
+      return "defer+madvise";
+    default:
+      return "Unknown";
+    }
+  }
+
+
+  std::string to_string( platform::pressure_resource r_ )
+  {
+    switch ( r_ )
+    {
+    case platform::pressure_resource::cpu:
+      return "CPU";
+    case platform::pressure_resource::memory:
+      return "Memory";
+    case platform::pressure_resource::io:
+      return "IO";
+    default:
+      return "Unknown";
+    }
+  }
+
+
+  std::string to_string( platform::cache_type t_ )
+  {
+    switch ( t_ )
+    {
+    case platform::cache_type::data:
+      return "Data";
+    case platform::cache_type::instruction:
+      return "Instruction";
+    case platform::cache_type::unified:
+      return "Unified";
+    default:
+      return "Unknown";
+    }
+  }
+
 } // namespace ll
 
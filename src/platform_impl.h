@@ -21,7 +21,9 @@
 #include "systeminfo/platform.h"
 
 #include <string>
+#include <thread>
 #include <tuple>
+#include <vector>
 
 
 namespace ll
@@ -44,9 +46,55 @@ namespace platform
     cpu_info get_static_cpu_info();
 
     void get_dynamic_cpu_info( cpu_info& info_ );
+
+    //! fills the allowed logical cores and the quota, an empty core list means all cores are allowed
+    cpu_budget get_cpu_budget();
+
+    void get_cpu_times( cpu_times& times_ );
+
+    //! returns an empty numa_info if the platform doesn't report numa nodes
+    numa_info get_numa_info();
+
+    void set_thread_affinity( std::thread::native_handle_type thread_, const std::vector< unsigned >& cpus_ );
+
+    void set_current_thread_affinity( const std::vector< unsigned >& cpus_ );
   
+    hugepage_info get_hugepage_info();
+
+    //! the base page size first, followed by the huge page sizes
+    std::vector< std::uint64_t > get_page_sizes();
+
+    //! returns false if pressure stall information is not available
+    bool get_pressure_info( pressure_resource resource_, pressure_scope scope_, pressure_info& info_ );
+
+    //! returns a handle that has to be released with close_pressure_trigger
+    int open_pressure_trigger(
+      pressure_resource resource_,
+      pressure_stall stall_,
+      std::uint64_t thresholdInMicroseconds_,
+      std::uint64_t windowInMicroseconds_,
+      pressure_scope scope_
+    );
+
+    void close_pressure_trigger( int handle_ );
+
+    //! fills fired_ with the indices of the handles that fired, stays empty on a timeout
+    void wait_for_pressure( 
+      const std::vector< int >& handles_, 
+      int timeoutInMilliseconds_, 
+      std::vector< size_t >& fired_ 
+    );
+
     gpu_info get_gpu_info();
 
+#if defined( __linux__ )
+    //! reads the numa topology from a sysfs tree, systemDirectory_ corresponds to /sys/devices/system
+    numa_info get_numa_info( const std::string& systemDirectory_ );
+
+    //! builds the processor hierarchy from a sysfs tree, cpuDirectory_ corresponds to /sys/devices/system/cpu
+    cpu_info get_cpu_topology( const std::string& cpuDirectory_ );
+#endif
+
   }  // namespace impl
 
 }  // namespace platform
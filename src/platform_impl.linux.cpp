@@ -19,6 +19,8 @@
 #include "platform_impl.h"
 
 #include "systeminfo/exception.h"
+#include "cgroup.linux.h"
+#include "file_utils.linux.h"
 
 #include <base/environment.h>
 #include <platform_utils/linux/shell_utils.h>
@@ -29,11 +31,22 @@ LL_WARNING_DISABLE_GCC( deprecated-declarations )
 LL_WARNING_ENABLE_GCC( deprecated-declarations )
 
 
+#include <algorithm>
 #include <array>
+#include <initializer_list>
+#include <tuple>
 #include <vector>
 #include <map>
+#include <mutex>
+#include <cstring>
 #include <iostream>
 
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
 
 namespace ll
 {
@@ -44,9 +57,7 @@ namespace platform
   namespace
   {
     using cpu_info_t = std::map< std::string, std::string >;
-    using cpu_speed_t = std::vector< unsigned >;
     using gpu_info_t = std::vector< std::string >;
-    using memory_info_t = std::map< std::string, std::string >;
     
     const cpu_info_t& get_static_processor_info()
     {
@@ -68,20 +79,632 @@ namespace platform
     }
 
    
-    cpu_speed_t get_dynamic_processor_info()
+    const char* s_cpuDirectory = "/sys/devices/system/cpu";
+
+    const int s_fdNotOpened = -2;
+
+
+    //! returns the value of the first line in /proc/cpuinfo that starts with key_
+    std::string get_cpuinfo_value( const std::string& key_ )
     {
-      cpu_speed_t speed;
+      std::string content;
+      if( !detail::read_file( "/proc/cpuinfo", content ) )
+        return std::string();
 
-      auto s = utils::execute_shell_command( "export LANG=C;cat /proc/cpuinfo | grep \"cpu MHz\"" );
-      boost::char_separator< char > separator{ ":\n" };
-      boost::tokenizer< boost::char_separator<char> >  tokenizer{ s, separator };
-      for ( auto it = tokenizer.begin(); it != tokenizer.end(); ++it )
-        speed.push_back( std::stoi( *(++it) ) );
-      
-      return speed;
+      size_t pos = 0;
+      while( pos < content.size() )
+      {
+        auto eol = content.find( '\n', pos );
+        if( eol == std::string::npos )
+          eol = content.size();
+
+        if( content.compare( pos, key_.size(), key_ ) == 0 )
+        {
+          auto colon = content.find( ':', pos );
+          if( ( colon != std::string::npos ) && ( colon < eol ) )
+            return boost::trim_copy( content.substr( colon + 1, eol - colon - 1 ) );
+        }
+
+        pos = eol + 1;
+      }
+
+      return std::string();
+    }
+
+
+    //! samples the current frequency of every logical core through file descriptors that stay open
+    class frequency_sampler
+    {
+    public:
+      frequency_sampler() = default;
+      frequency_sampler( const frequency_sampler& ) = delete;
+      frequency_sampler& operator=( const frequency_sampler& ) = delete;
+
+      ~frequency_sampler()
+      {
+        for( auto fd : m_fds )
+        {
+          if( fd >= 0 )
+            ::close( fd );
+        }
+      }
+
+      void update( cpu_info& info_ )
+      {
+        std::lock_guard< std::mutex > lock( m_mutex );
+
+        // index the logical cores by their os id, this only allocates when a core with a higher id shows up
+        std::fill( m_cores.begin(), m_cores.end(), nullptr );
+        for( auto& p : info_.processorPacks )
+        {
+          for( auto& c : p.physicalCores )
+          {
+            for( auto& l : c.logicalCores )
+            {
+              if( l.id >= m_cores.size() )
+              {
+                m_cores.resize( l.id + 1, nullptr );
+                m_fds.resize( l.id + 1, s_fdNotOpened );
+              }
+              m_cores[ l.id ] = &l;
+            }
+          }
+        }
+
+        bool missing = false;
+        for( size_t id = 0; id < m_cores.size(); ++id )
+        {
+          if( !m_cores[ id ] )
+            continue;
+
+          if( m_fds[ id ] == s_fdNotOpened )
+            m_fds[ id ] = open_cpufreq( static_cast< unsigned >( id ) );
+
+          std::uint64_t kHz = 0;
+          if( ( m_fds[ id ] >= 0 ) && read_value( m_fds[ id ], kHz ) )
+            m_cores[ id ]->currentSpeedInMHz = static_cast< unsigned >( kHz / 1000 );
+          else
+            missing = true;
+        }
+
+        if( missing )
+          update_from_cpuinfo();
+      }
+
+    private:
+      static int open_cpufreq( unsigned id_ )
+      {
+        auto path = std::string( s_cpuDirectory ) + "/cpu" + std::to_string( id_ ) 
+          + "/cpufreq/scaling_cur_freq";
+        return ::open( path.c_str(), O_RDONLY | O_CLOEXEC );
+      }
+
+
+      static bool read_value( int fd_, std::uint64_t& value_ )
+      {
+        std::array< char, 32 > buffer;
+        auto count = ::pread( fd_, buffer.data(), buffer.size(), 0 );
+        if( count <= 0 )
+          return false;
+
+        const char* p = buffer.data();
+        value_ = detail::parse_uint( p, p + count );
+        return true;
+      }
+
+
+      //! fallback if cpufreq is not available (e.g. in virtual machines), one read for all cores
+      void update_from_cpuinfo()
+      {
+        if( !m_cpuinfo.is_open() && !m_cpuinfo.open( "/proc/cpuinfo" ) )
+          return;
+
+        if( !m_cpuinfo.read() )
+          return;
+
+        static const char processorKey[] = "processor";
+        static const char speedKey[] = "cpu MHz";
+
+        size_t cpu = 0;
+        const char* p = m_cpuinfo.data();
+        const char* end = m_cpuinfo.end();
+        while( p != end )
+        {
+          const char* key = p;
+          while( ( p != end ) && ( *p != ':' ) && ( *p != '\n' ) )
+            ++p;
+
+          auto length = static_cast< size_t >( p - key );
+          if( ( p != end ) && ( *p == ':' ) )
+          {
+            ++p;
+            if( ( length >= sizeof( processorKey ) - 1 )
+              && ( std::memcmp( key, processorKey, sizeof( processorKey ) - 1 ) == 0 ) )
+            {
+              cpu = static_cast< size_t >( detail::parse_uint( p, end ) );
+            }
+            else if( ( length >= sizeof( speedKey ) - 1 )
+              && ( std::memcmp( key, speedKey, sizeof( speedKey ) - 1 ) == 0 )
+              && ( cpu < m_cores.size() ) && m_cores[ cpu ] )
+            {
+              m_cores[ cpu ]->currentSpeedInMHz = static_cast< unsigned >( detail::parse_uint( p, end ) );
+            }
+          }
+
+          detail::skip_line( p, end );
+        }
+      }
+
+
+      std::mutex m_mutex;
+      std::vector< int > m_fds;                         // indexed by the os cpu id
+      std::vector< cpu_info::logical_core* > m_cores;   // indexed by the os cpu id
+      detail::proc_file m_cpuinfo;
+    };
+
+
+    //! keeps /proc/stat open and parses the per-cpu time counters
+    class stat_reader
+    {
+    public:
+      stat_reader() : m_file( "/proc/stat" ) {}
+
+      bool read( cpu_times& times_ )
+      {
+        std::lock_guard< std::mutex > lock( m_mutex );
+
+        if( !m_file.read() )
+          return false;
+
+        times_.total = cpu_times::logical_core();
+        std::fill( times_.logicalCores.begin(), times_.logicalCores.end(), cpu_times::logical_core() );
+
+        const char* p = m_file.data();
+        const char* end = m_file.end();
+        while( ( end - p > 3 ) && ( std::memcmp( p, "cpu", 3 ) == 0 ) )
+        {
+          p += 3;
+
+          cpu_times::logical_core* core = &times_.total;
+          if( ( *p >= '0' ) && ( *p <= '9' ) )
+          {
+            auto id = static_cast< size_t >( detail::parse_uint( p, end ) );
+            if( id >= times_.logicalCores.size() )
+              times_.logicalCores.resize( id + 1 );
+            core = &times_.logicalCores[ id ];
+          }
+
+          core->user = detail::parse_uint( p, end );
+          core->nice = detail::parse_uint( p, end );
+          core->system = detail::parse_uint( p, end );
+          core->idle = detail::parse_uint( p, end );
+          core->iowait = detail::parse_uint( p, end );
+          core->irq = detail::parse_uint( p, end );
+          core->softirq = detail::parse_uint( p, end );
+          core->steal = detail::parse_uint( p, end );
+
+          detail::skip_line( p, end );
+        }
+
+        return true;
+      }
+
+    private:
+      std::mutex m_mutex;
+      detail::proc_file m_file;
+    };
+
+
+    //! parses the "Node N MemTotal: X kB" format of /sys/devices/system/node/nodeN/meminfo
+    void read_node_memory( const std::string& path_, numa_info::node& node_ )
+    {
+      detail::proc_file file( path_ );
+      if( !file.read() )
+        return;
+
+      static const char totalKey[] = "MemTotal:";
+      static const char freeKey[] = "MemFree:";
+
+      const char* p = file.data();
+      const char* end = file.end();
+      while( p != end )
+      {
+        const char* eol = std::find( p, end, '\n' );
+        const char* colon = std::find( p, eol, ':' );
+        if( colon != eol )
+        {
+          const char* key = colon;
+          while( ( key != p ) && ( *( key - 1 ) != ' ' ) )
+            --key;
+
+          auto length = static_cast< size_t >( colon - key ) + 1;
+          const char* value = colon + 1;
+          if( ( length == sizeof( totalKey ) - 1 ) && ( std::memcmp( key, totalKey, length ) == 0 ) )
+            node_.totalMemoryInBytes = detail::parse_uint( value, eol ) * 1024;
+          else if( ( length == sizeof( freeKey ) - 1 ) && ( std::memcmp( key, freeKey, length ) == 0 ) )
+            node_.freeMemoryInBytes = detail::parse_uint( value, eol ) * 1024;
+        }
+
+        p = ( eol == end ) ? end : eol + 1;
+      }
     }
 
 
+    //! parses sysfs sizes such as "48K"
+    std::uint64_t parse_size( const std::string& value_ )
+    {
+      const char* p = value_.data();
+      const char* end = p + value_.size();
+      auto size = detail::parse_uint( p, end );
+      if( p != end )
+      {
+        switch( *p )
+        {
+          case 'K': return size << 10;
+          case 'M': return size << 20;
+          case 'G': return size << 30;
+          default: break;
+        }
+      }
+      return size;
+    }
+
+
+    cache_type to_cache_type( const std::string& type_ )
+    {
+      if( type_ == "Data" )
+        return cache_type::data;
+      if( type_ == "Instruction" )
+        return cache_type::instruction;
+      if( type_ == "Unified" )
+        return cache_type::unified;
+      return cache_type::unknown;
+    }
+
+
+    //! collects the cache instances from /sys/devices/system/cpu/cpu*/cache/index*
+    std::vector< cpu_info::cache > get_caches( const std::string& cpuDirectory_, const cpu_info& info_ )
+    {
+      std::vector< cpu_info::cache > caches;
+
+      for( const auto& p : info_.processorPacks )
+      {
+        for( const auto& c : p.physicalCores )
+        {
+          for( const auto& l : c.logicalCores )
+          {
+            auto cacheDirectory = cpuDirectory_ + "/cpu" + std::to_string( l.id ) + "/cache";
+            for( auto index : detail::list_numbered_entries( cacheDirectory, "index" ) )
+            {
+              auto directory = cacheDirectory + "/index" + std::to_string( index ) + "/";
+
+              cpu_info::cache cache;
+              cache.level = static_cast< unsigned >( detail::read_uint( directory + "level" ) );
+              cache.type = to_cache_type( detail::read_line( directory + "type" ) );
+              cache.logicalCores = 
+                detail::parse_cpu_list( detail::read_line( directory + "shared_cpu_list" ) );
+              if( cache.logicalCores.empty() )
+                cache.logicalCores.push_back( l.id );
+
+              // every instance is reported by all of the cores sharing it
+              auto known = std::find_if( caches.begin(), caches.end(), [&cache]( const cpu_info::cache& c_ )
+              {
+                return ( c_.level == cache.level ) && ( c_.type == cache.type )
+                  && ( c_.logicalCores == cache.logicalCores );
+              } );
+              if( known != caches.end() )
+                continue;
+
+              cache.sizeInBytes = parse_size( detail::read_line( directory + "size" ) );
+              cache.lineSizeInBytes = 
+                static_cast< unsigned >( detail::read_uint( directory + "coherency_line_size" ) );
+              cache.associativity = 
+                static_cast< unsigned >( detail::read_uint( directory + "ways_of_associativity" ) );
+              caches.push_back( cache );
+            }
+          }
+        }
+      }
+
+      return caches;
+    }
+
+
+    //! reads an id from sysfs, some architectures report -1 for unknown ids
+    unsigned read_topology_id( const std::string& path_ )
+    {
+      auto value = detail::read_line( path_ );
+      if( value.empty() || ( value[ 0 ] == '-' ) )
+        return 0;
+
+      const char* p = value.data();
+      return static_cast< unsigned >( detail::parse_uint( p, p + value.size() ) );
+    }
+
+
+    //! the processors the calling process may be scheduled on
+    std::vector< unsigned > get_process_affinity()
+    {
+      std::vector< unsigned > result;
+
+      // the kernel rejects sets that are smaller than its own cpu mask, grow until it fits
+      auto configured = ::sysconf( _SC_NPROCESSORS_CONF );
+      for( size_t count = ( configured > 0 ) ? configured : 64; count <= ( 1u << 16 ); count *= 2 )
+      {
+        cpu_set_t* set = CPU_ALLOC( count );
+        if( !set )
+          break;
+
+        auto size = CPU_ALLOC_SIZE( count );
+        if( ::sched_getaffinity( 0, size, set ) == 0 )
+        {
+          for( size_t cpu = 0; cpu < size * 8; ++cpu )
+          {
+            if( CPU_ISSET_S( cpu, size, set ) )
+              result.push_back( static_cast< unsigned >( cpu ) );
+          }
+
+          CPU_FREE( set );
+          break;
+        }
+
+        CPU_FREE( set );
+        if( errno != EINVAL )
+          break;
+      }
+
+      return result;
+    }
+
+
+    //! the processors of the cgroup's cpuset, empty if there is no cpuset controller
+    std::vector< unsigned > get_cgroup_cpuset()
+    {
+      auto cgroup = detail::find_cgroup( "cpuset" );
+      if( cgroup.empty() )
+        return std::vector< unsigned >();
+
+      auto list = detail::read_line( 
+        cgroup.directory + ( cgroup.unified ? "/cpuset.cpus.effective" : "/cpuset.effective_cpus" ) 
+      );
+      if( list.empty() && !cgroup.unified )
+        list = detail::read_line( cgroup.directory + "/cpuset.cpus" );
+
+      return detail::parse_cpu_list( list );
+    }
+
+
+    //! reads "$QUOTA $PERIOD" (v2) or just the quota (v1), a limit of "max" or -1 means unlimited
+    bool read_cpu_quota( const std::string& path_, std::uint64_t& quota_, std::uint64_t& period_ )
+    {
+      auto line = detail::read_line( path_ );
+      if( line.empty() || ( line[ 0 ] < '0' ) || ( line[ 0 ] > '9' ) )
+        return false;
+
+      const char* p = line.c_str();
+      quota_ = detail::parse_uint( p, line.c_str() + line.size() );
+      period_ = detail::parse_uint( p, line.c_str() + line.size() );
+      return quota_ > 0;
+    }
+
+
+    //! the tightest cpu bandwidth limit along the cgroup hierarchy, false if there is none
+    bool get_cgroup_cpu_quota( std::uint64_t& quota_, std::uint64_t& period_ )
+    {
+      auto cgroup = detail::find_cgroup( "cpu" );
+
+      bool limited = false;
+      for( const auto& directory : cgroup.hierarchy() )
+      {
+        std::uint64_t quota = 0;
+        std::uint64_t period = 0;
+
+        if( cgroup.unified )
+        {
+          if( !read_cpu_quota( directory + "/cpu.max", quota, period ) )
+            continue;
+        }
+        else
+        {
+          if( !read_cpu_quota( directory + "/cpu.cfs_quota_us", quota, period ) )
+            continue;
+          period = detail::read_uint( directory + "/cpu.cfs_period_us" );
+        }
+
+        if( period == 0 )
+          continue;
+
+        auto share = static_cast< double >( quota ) / period;
+        if( !limited || ( share < static_cast< double >( quota_ ) / period_ ) )
+        {
+          quota_ = quota;
+          period_ = period;
+          limited = true;
+        }
+      }
+
+      return limited;
+    }
+
+
+    template< size_t N >
+    bool is_key( const char* key_, size_t length_, const char ( &name_ )[ N ] )
+    {
+      return ( length_ == N - 1 ) && ( std::memcmp( key_, name_, length_ ) == 0 );
+    }
+
+
+    //! /proc/pressure/<resource> or <cgroup>/<resource>.pressure, empty if there is no cgroup v2
+    std::string get_pressure_path( pressure_resource resource_, pressure_scope scope_ )
+    {
+      static const char* const s_names[] = { "cpu", "memory", "io" };
+      auto name = s_names[ static_cast< size_t >( resource_ ) ];
+
+      if( scope_ == pressure_scope::system )
+        return std::string( "/proc/pressure/" ) + name;
+
+      auto cgroup = detail::find_cgroup( std::string() );
+      return cgroup.empty() ? std::string() : cgroup.directory + "/" + name + ".pressure";
+    }
+
+
+    //! parses a fixed point value such as 12.34 without going through the locale dependent strtod
+    double parse_decimal( const char*& p_, const char* end_ )
+    {
+      auto value = static_cast< double >( detail::parse_uint( p_, end_ ) );
+      if( ( p_ != end_ ) && ( *p_ == '.' ) )
+      {
+        ++p_;
+        double scale = 0.1;
+        while( ( p_ != end_ ) && ( *p_ >= '0' ) && ( *p_ <= '9' ) )
+        {
+          value += scale * ( *p_++ - '0' );
+          scale /= 10;
+        }
+      }
+      return value;
+    }
+
+
+    //! parses the size from a sysfs hugepage directory name such as hugepages-2048kB, 0 if it doesn't match
+    std::uint64_t parse_hugepage_size( const std::string& name_ )
+    {
+      static const char prefix[] = "hugepages-";
+      if( name_.compare( 0, sizeof( prefix ) - 1, prefix ) != 0 )
+        return 0;
+
+      const char* p = name_.c_str() + sizeof( prefix ) - 1;
+      auto sizeInKB = detail::parse_uint( p, name_.c_str() + name_.size() );
+      return ( std::strcmp( p, "kB" ) == 0 ) ? sizeInKB * 1024 : 0;
+    }
+
+
+    //! the selected value of a sysfs mode list such as "always [madvise] never"
+    transparent_hugepage_mode read_transparent_hugepage_mode( const std::string& path_ )
+    {
+      auto line = detail::read_line( path_ );
+      auto first = line.find( '[' );
+      auto last = line.find( ']', first );
+      if( ( first == std::string::npos ) || ( last == std::string::npos ) )
+        return transparent_hugepage_mode::unknown;
+
+      auto mode = line.substr( first + 1, last - first - 1 );
+      if( mode == "always" )
+        return transparent_hugepage_mode::always;
+      if( mode == "madvise" )
+        return transparent_hugepage_mode::madvise;
+      if( mode == "never" )
+        return transparent_hugepage_mode::never;
+      if( mode == "defer" )
+        return transparent_hugepage_mode::defer;
+      if( mode == "defer+madvise" )
+        return transparent_hugepage_mode::defer_madvise;
+
+      return transparent_hugepage_mode::unknown;
+    }
+
+
+    struct kb_field
+    {
+      const char* key;
+      std::uint64_t* valueInBytes;
+    };
+
+    //! adds up the "Key:   123 kB" lines of /proc/meminfo or smaps style files
+    void add_kb_fields( const std::string& path_, std::initializer_list< kb_field > fields_ )
+    {
+      detail::proc_file file( path_ );
+      if( !file.read() )
+        return;
+
+      const char* p = file.data();
+      const char* end = file.end();
+      while( p != end )
+      {
+        const char* key = p;
+        while( ( p != end ) && ( *p != ':' ) && ( *p != '\n' ) )
+          ++p;
+
+        auto length = static_cast< size_t >( p - key );
+        if( ( p != end ) && ( *p == ':' ) )
+        {
+          ++p;
+          for( const auto& f : fields_ )
+          {
+            if( ( std::strlen( f.key ) == length ) && ( std::memcmp( key, f.key, length ) == 0 ) )
+              *f.valueInBytes += detail::parse_uint( p, end ) * 1024;
+          }
+        }
+
+        detail::skip_line( p, end );
+      }
+    }
+
+
+    //! keeps the pressure files open, one per resource and scope
+    class pressure_reader
+    {
+    public:
+      bool read( pressure_resource resource_, pressure_scope scope_, pressure_info& info_ )
+      {
+        std::lock_guard< std::mutex > lock( m_mutex );
+
+        auto& file = m_files[ static_cast< size_t >( scope_ ) ][ static_cast< size_t >( resource_ ) ];
+        if( !file.is_open() && !file.open( get_pressure_path( resource_, scope_ ) ) )
+          return false;
+
+        if( !file.read() )
+          return false;
+
+        // some avg10=0.00 avg60=0.00 avg300=0.00 total=0
+        // full avg10=0.00 avg60=0.00 avg300=0.00 total=0
+        info_ = pressure_info();
+
+        const char* p = file.data();
+        const char* end = file.end();
+        while( end - p > 4 )
+        {
+          pressure_info::stall* stall = nullptr;
+          if( std::memcmp( p, "some", 4 ) == 0 )
+            stall = &info_.some;
+          else if( std::memcmp( p, "full", 4 ) == 0 )
+            stall = &info_.full;
+
+          while( stall && ( p != end ) && ( *p != '\n' ) )
+          {
+            while( ( p != end ) && ( *p != '=' ) && ( *p != '\n' ) )
+              ++p;
+            if( ( p == end ) || ( *p == '\n' ) )
+              break;
+
+            const char* key = p - 1;
+            while( ( key != file.data() ) && ( key[ -1 ] != ' ' ) )
+              --key;
+            auto length = static_cast< size_t >( p - key );
+            ++p;
+
+            if( is_key( key, length, "avg10" ) )
+              stall->avg10 = parse_decimal( p, end );
+            else if( is_key( key, length, "avg60" ) )
+              stall->avg60 = parse_decimal( p, end );
+            else if( is_key( key, length, "avg300" ) )
+              stall->avg300 = parse_decimal( p, end );
+            else if( is_key( key, length, "total" ) )
+              stall->totalInMicroseconds = detail::parse_uint( p, end );
+          }
+
+          detail::skip_line( p, end );
+        }
+
+        return true;
+      }
+
+    private:
+      std::mutex m_mutex;
+      detail::proc_file m_files[ 2 ][ 3 ];  // by scope and resource
+    };
+
+
     const gpu_info_t& get_raw_gpu_info()
     {
       static gpu_info_t s_gpuInfo;
@@ -101,23 +724,227 @@ namespace platform
     }
 
 
-    memory_info_t get_raw_memory_info()
+    //! keeps /proc/meminfo open and parses only the fields needed for memory_info
+    class meminfo_reader
     {
-      memory_info_t info;  // not static, because the 'available' information changes
-      
-      //! \todo this is pretty inefficient when called multiple times
+    public:
+      meminfo_reader() : m_file( "/proc/meminfo" ) {}
 
-      auto s = utils::execute_shell_command( "cat /proc/meminfo" );
-      boost::char_separator< char > separator{ ":\n" };
-      boost::tokenizer< boost::char_separator<char> >  tokenizer{ s, separator };
-      for ( auto it = tokenizer.begin(); it != tokenizer.end(); ++it )
+      bool read( memory_info& info_ )
       {
-        auto key = *it;
-        info[ key ] = boost::replace_all_copy( *(++it), "\"", "" );
+        std::lock_guard< std::mutex > lock( m_mutex );
+
+        if( !m_file.read() )
+          return false;
+
+        std::uint64_t memTotal = 0, memFree = 0, memAvailable = 0, swapTotal = 0, swapFree = 0;
+        bool hasMemAvailable = false;
+
+        const char* p = m_file.data();
+        const char* end = m_file.end();
+        while( p != end )
+        {
+          const char* key = p;
+          while( ( p != end ) && ( *p != ':' ) && ( *p != '\n' ) )
+            ++p;
+
+          auto length = static_cast< size_t >( p - key );
+          if( ( p != end ) && ( *p == ':' ) )
+          {
+            ++p;
+            if( is_key( key, length, "MemTotal" ) )
+              memTotal = detail::parse_uint( p, end );
+            else if( is_key( key, length, "MemFree" ) )
+              memFree = detail::parse_uint( p, end );
+            else if( is_key( key, length, "MemAvailable" ) )
+            {
+              memAvailable = detail::parse_uint( p, end );
+              hasMemAvailable = true;
+            }
+            else if( is_key( key, length, "SwapTotal" ) )
+              swapTotal = detail::parse_uint( p, end );
+            else if( is_key( key, length, "SwapFree" ) )
+              swapFree = detail::parse_uint( p, end );
+          }
+
+          detail::skip_line( p, end );
+        }
+
+        // MemAvailable exists since linux 3.14
+        if( !hasMemAvailable )
+          memAvailable = memFree;
+
+        info_.totalPhysicalMemoryInBytes = memTotal * 1024;
+        info_.availablePhysicalMemoryInBytes = memAvailable * 1024;
+        info_.freePhysicalMemoryInBytes = memFree * 1024;
+        info_.totalVirtualMemoryInBytes = ( memTotal + swapTotal ) * 1024;
+        info_.availableVirtualMemoryInBytes = ( memAvailable + swapFree ) * 1024;
+        return true;
       }
-      
-      return info;
-    }
+
+    private:
+      std::mutex m_mutex;
+      detail::proc_file m_file;
+    };
+
+
+    //! keeps the memory controller files of the process' cgroup and its parents open
+    class cgroup_memory_reader
+    {
+    public:
+      cgroup_memory_reader()
+      {
+        auto cgroup = detail::find_cgroup( "memory" );
+        m_unified = cgroup.unified;
+
+        for( const auto& directory : cgroup.hierarchy() )
+        {
+          level l;
+          if( m_unified )
+          {
+            l.max.open( directory + "/memory.max" );
+            l.high.open( directory + "/memory.high" );
+            l.swapMax.open( directory + "/memory.swap.max" );
+            l.current.open( directory + "/memory.current" );
+          }
+          else
+          {
+            l.max.open( directory + "/memory.limit_in_bytes" );
+            l.swapMax.open( directory + "/memory.memsw.limit_in_bytes" );
+            l.current.open( directory + "/memory.usage_in_bytes" );
+          }
+          m_levels.push_back( std::move( l ) );
+        }
+
+        if( !cgroup.empty() )
+        {
+          m_stat.open( cgroup.directory + "/memory.stat" );
+          if( !m_unified )
+            m_kernel.open( cgroup.directory + "/memory.kmem.usage_in_bytes" );
+        }
+      }
+
+      //! headroom_ is the memory left below the tightest limit (or high threshold) of the hierarchy
+      void read( cgroup_memory_info& info_, std::uint64_t& headroom_ )
+      {
+        std::lock_guard< std::mutex > lock( m_mutex );
+
+        info_ = cgroup_memory_info();
+        headroom_ = unlimitedMemory;
+
+        for( size_t i = 0; i < m_levels.size(); ++i )
+        {
+          auto& l = m_levels[ i ];
+
+          auto max = read_limit( l.max );
+          auto high = read_limit( l.high );
+          auto usage = read_limit( l.current );
+          if( usage == unlimitedMemory )
+            usage = 0;
+
+          // v1 accounts memory + swap, the swap limit is the difference
+          auto swapMax = read_limit( l.swapMax );
+          if( !m_unified && ( swapMax != unlimitedMemory ) && ( max != unlimitedMemory ) )
+            swapMax = ( swapMax > max ) ? swapMax - max : 0;
+
+          info_.limitInBytes = std::min( info_.limitInBytes, max );
+          info_.highInBytes = std::min( info_.highInBytes, high );
+          info_.swapLimitInBytes = std::min( info_.swapLimitInBytes, swapMax );
+          if( i == 0 )
+            info_.usageInBytes = usage;
+
+          auto limit = std::min( max, high );
+          if( limit != unlimitedMemory )
+            headroom_ = std::min( headroom_, ( limit > usage ) ? limit - usage : 0 );
+        }
+
+        auto inactiveFile = read_stat( info_ );
+        if( headroom_ != unlimitedMemory )
+          headroom_ += inactiveFile;  // the kernel reclaims the inactive page cache before it hits the limit
+      }
+
+    private:
+      struct level
+      {
+        detail::proc_file max;
+        detail::proc_file high;
+        detail::proc_file swapMax;
+        detail::proc_file current;
+      };
+
+      //! "max" (v2) and the page counter maximum (v1) mean unlimited, a file that can't be read as well
+      static std::uint64_t read_limit( detail::proc_file& file_ )
+      {
+        if( !file_.is_open() || !file_.read() )
+          return unlimitedMemory;
+
+        const char* p = file_.data();
+        if( ( *p < '0' ) || ( *p > '9' ) )
+          return unlimitedMemory;
+
+        auto value = detail::parse_uint( p, file_.end() );
+        return ( value >= s_v1Unlimited ) ? unlimitedMemory : value;
+      }
+
+      //! parses the breakdown from memory.stat, returns the inactive page cache
+      std::uint64_t read_stat( cgroup_memory_info& info_ )
+      {
+        if( !m_stat.is_open() || !m_stat.read() )
+          return 0;
+
+        std::uint64_t inactiveFile = 0, slab = 0, kernelStack = 0, pageTables = 0;
+        bool hasKernel = false;
+
+        const char* p = m_stat.data();
+        const char* end = m_stat.end();
+        while( p != end )
+        {
+          const char* key = p;
+          while( ( p != end ) && ( *p != ' ' ) && ( *p != '\n' ) )
+            ++p;
+
+          auto length = static_cast< size_t >( p - key );
+          if( m_unified ? is_key( key, length, "anon" ) : is_key( key, length, "rss" ) )
+            info_.anonInBytes = detail::parse_uint( p, end );
+          else if( m_unified ? is_key( key, length, "file" ) : is_key( key, length, "cache" ) )
+            info_.fileInBytes = detail::parse_uint( p, end );
+          else if( is_key( key, length, "shmem" ) )
+            info_.shmemInBytes = detail::parse_uint( p, end );
+          else if( is_key( key, length, "inactive_file" ) )
+            inactiveFile = detail::parse_uint( p, end );
+          else if( is_key( key, length, "kernel" ) )
+          {
+            info_.kernelInBytes = detail::parse_uint( p, end );
+            hasKernel = true;
+          }
+          else if( is_key( key, length, "slab" ) )
+            slab = detail::parse_uint( p, end );
+          else if( is_key( key, length, "kernel_stack" ) )
+            kernelStack = detail::parse_uint( p, end );
+          else if( is_key( key, length, "pagetables" ) )
+            pageTables = detail::parse_uint( p, end );
+
+          detail::skip_line( p, end );
+        }
+
+        // the kernel entry exists since linux 5.18, v1 has a separate counter
+        if( !m_unified )
+          info_.kernelInBytes = ( read_limit( m_kernel ) != unlimitedMemory ) ? read_limit( m_kernel ) : 0;
+        else if( !hasKernel )
+          info_.kernelInBytes = slab + kernelStack + pageTables;
+
+        return inactiveFile;
+      }
+
+      // v1 reports PAGE_COUNTER_MAX (rounded to pages) if there is no limit
+      static const std::uint64_t s_v1Unlimited = 0x7FFFFFFFFFFFF000ull;
+
+      std::mutex m_mutex;
+      bool m_unified = false;
+      std::vector< level > m_levels;  // the process' cgroup first, then its parents
+      detail::proc_file m_stat;
+      detail::proc_file m_kernel;
+    };
 
   }
 
@@ -164,37 +991,124 @@ namespace platform
 
     std::string get_processor_name()
     {
+      auto name = get_cpuinfo_value( "model name" );
+      if( !name.empty() )
+        return name;
+
+      // not all architectures report the model name in /proc/cpuinfo, lscpu knows how to decode it
       auto it = get_static_processor_info().find( "Model name" );
-      return ( it == get_static_processor_info().end() ) ? "" : it->second;
+      return ( it == get_static_processor_info().end() ) ? "" : boost::trim_copy( it->second );
     }
 
     
     // -------------------------------------------------------------------------------------------------------
 
-    cpu_info get_static_cpu_info()
+    cpu_info get_cpu_topology( const std::string& cpuDirectory_ )
     {
-      cpu_info info;
-    
-      auto cpuInfo = get_static_processor_info();  //! \todo this is a copy
+      struct logical_cpu
+      {
+        unsigned id;
+        unsigned package;
+        unsigned die;
+        unsigned cluster;
+        unsigned core;
+        unsigned firstSibling;  // identifies the physical core the logical core belongs to
+        unsigned numaNode;
+        unsigned maximumSpeedInMHz;
+      };
 
-      auto packageCount = std::stoi( boost::trim_copy( cpuInfo[ "Socket(s)" ] ) );      
-      auto logicalCoreCount = std::stoi( boost::trim_copy( cpuInfo[ "CPU(s)" ] ) );
-      auto coresPerSocket = std::stoi( boost::trim_copy( cpuInfo[ "Core(s) per socket" ] ) );
-      auto cpuMaxMHz = std::stoi( boost::trim_copy( cpuInfo[ "CPU max MHz" ] ) );
+      auto isolated = detail::parse_cpu_list( detail::read_line( cpuDirectory_ + "/isolated" ) );
+      auto nohzFull = detail::parse_cpu_list( detail::read_line( cpuDirectory_ + "/nohz_full" ) );
+      isolated.insert( isolated.end(), nohzFull.begin(), nohzFull.end() );
+
+      std::vector< logical_cpu > cpus;
+      for( auto id : detail::list_numbered_entries( cpuDirectory_, "cpu" ) )
+      {
+        auto cpuDirectory = cpuDirectory_ + "/cpu" + std::to_string( id );
+        auto topologyDirectory = cpuDirectory + "/topology/";
+
+        // offline cpus don't expose their topology
+        auto siblings = 
+          detail::parse_cpu_list( detail::read_line( topologyDirectory + "thread_siblings_list" ) );
+        if( siblings.empty() )
+          continue;
+
+        logical_cpu cpu;
+        cpu.id = id;
+        cpu.package = read_topology_id( topologyDirectory + "physical_package_id" );
+        cpu.die = read_topology_id( topologyDirectory + "die_id" );
+        cpu.cluster = read_topology_id( topologyDirectory + "cluster_id" );
+        cpu.core = read_topology_id( topologyDirectory + "core_id" );
+        cpu.firstSibling = siblings.front();
+
+        auto nodes = detail::list_numbered_entries( cpuDirectory, "node" );
+        cpu.numaNode = nodes.empty() ? 0 : nodes.front();
+        cpu.maximumSpeedInMHz = static_cast< unsigned >(
+          detail::read_uint( cpuDirectory + "/cpufreq/cpuinfo_max_freq" ) / 1000
+        );
+        cpus.push_back( cpu );
+      }
 
-      info.processorPacks.resize( static_cast< size_t >( packageCount ) );
-      for( auto& p : info.processorPacks )
+      std::sort( cpus.begin(), cpus.end(), []( const logical_cpu& lhs_, const logical_cpu& rhs_ )
       {
-        p.physicalCores.resize( static_cast< size_t >( coresPerSocket ) );
-        for( auto& c : p.physicalCores )
+        return std::tie( lhs_.package, lhs_.die, lhs_.cluster, lhs_.firstSibling, lhs_.id )
+          < std::tie( rhs_.package, rhs_.die, rhs_.cluster, rhs_.firstSibling, rhs_.id );
+      } );
+
+      cpu_info info;
+      for( const auto& cpu : cpus )
+      {
+        if( info.processorPacks.empty() || ( info.processorPacks.back().id != cpu.package ) )
         {
-          c.logicalCores.resize( logicalCoreCount / packageCount / coresPerSocket );
-          for( auto& l : c.logicalCores )
-          {
-            l.maximumSpeedInMHz = cpuMaxMHz;
-          }
+          info.processorPacks.push_back( cpu_info::processor_pack() );
+          info.processorPacks.back().id = cpu.package;
+        }
+
+        auto& pack = info.processorPacks.back();
+        if( pack.physicalCores.empty() 
+          || ( pack.physicalCores.back().logicalCores.front().id != cpu.firstSibling ) )
+        {
+          pack.physicalCores.push_back( cpu_info::physical_core() );
+          pack.physicalCores.back().id = cpu.core;
+          pack.physicalCores.back().dieId = cpu.die;
+          pack.physicalCores.back().clusterId = cpu.cluster;
         }
+
+        cpu_info::logical_core core;
+        core.id = cpu.id;
+        core.numaNode = cpu.numaNode;
+        core.isolated = std::find( isolated.begin(), isolated.end(), cpu.id ) != isolated.end();
+        core.maximumSpeedInMHz = cpu.maximumSpeedInMHz;
+        pack.physicalCores.back().logicalCores.push_back( core );
       }
+
+      return info;
+    }
+
+
+    // -------------------------------------------------------------------------------------------------------
+
+    cpu_info get_static_cpu_info()
+    {
+      auto info = get_cpu_topology( s_cpuDirectory );
+      if( !info.processorPacks.empty() )
+      {
+        info.caches = get_caches( s_cpuDirectory, info );
+        return info;
+      }
+
+      // no sysfs available, assume a single package without smt
+      auto cpuCount = ::sysconf( _SC_NPROCESSORS_ONLN );
+      info.processorPacks.resize( 1 );
+      for( long i = 0; i < cpuCount; ++i )
+      {
+        cpu_info::physical_core core;
+        core.id = static_cast< unsigned >( i );
+        core.logicalCores.resize( 1 );
+        core.logicalCores.back().id = static_cast< unsigned >( i );
+        info.processorPacks.back().physicalCores.push_back( core );
+      }
+
       return info;
     }
 
@@ -203,23 +1117,307 @@ namespace platform
 
     void get_dynamic_cpu_info( cpu_info& info_ )
     {
-      auto speed = get_dynamic_processor_info();
-      
-      auto totalLogicalCoreCount = get_logical_core_count( info_ );
-      auto coresPerPack = totalLogicalCoreCount / info_.processorPacks.size();
-      auto logicalPerCore = totalLogicalCoreCount / get_physical_core_count( info_ );
-      size_t index = 0;
-      for( const auto& s : speed )
+      static frequency_sampler s_sampler;
+      s_sampler.update( info_ );
+    }
+
+
+    // -------------------------------------------------------------------------------------------------------
+
+    cpu_budget get_cpu_budget()
+    {
+      cpu_budget budget;
+      budget.allowedLogicalCores = get_process_affinity();
+
+      // the kernel applies the cpuset to the affinity mask already, intersecting covers stale masks
+      auto cpuset = get_cgroup_cpuset();
+      if( !cpuset.empty() && !budget.allowedLogicalCores.empty() )
       {
-        auto p = index / coresPerPack;
-        auto c = ( index % coresPerPack ) / 2;
-        auto l = index % logicalPerCore;
-        info_.processorPacks[ p ].physicalCores[ c ].logicalCores[l].currentSpeedInMHz = s;
-        ++index;
+        auto& allowed = budget.allowedLogicalCores;
+        allowed.erase( 
+          std::remove_if( allowed.begin(), allowed.end(), [&cpuset]( unsigned id_ ) 
+          { 
+            return !std::binary_search( cpuset.begin(), cpuset.end(), id_ ); 
+          } ),
+          allowed.end() 
+        );
       }
+
+      if( budget.allowedLogicalCores.empty() )
+        budget.allowedLogicalCores = cpuset;
+
+      get_cgroup_cpu_quota( budget.quotaInMicroseconds, budget.periodInMicroseconds );
+      return budget;
+    }
+
+
+    // -------------------------------------------------------------------------------------------------------
+
+    void get_cpu_times( cpu_times& times_ )
+    {
+      static stat_reader s_reader;
+      if( !s_reader.read( times_ ) )
+        throw exception( error::internal, "/proc/stat" );
     }
     
 
+    // -------------------------------------------------------------------------------------------------------
+
+    numa_info get_numa_info( const std::string& systemDirectory_ )
+    {
+      numa_info info;
+
+      auto nodeDirectory = systemDirectory_ + "/node";
+      auto ids = detail::list_numbered_entries( nodeDirectory, "node" );
+      if( ids.empty() )
+        return info;
+
+      info.nodes.resize( ids.back() + 1 );
+      for( size_t i = 0; i < info.nodes.size(); ++i )
+        info.nodes[ i ].id = static_cast< unsigned >( i );
+
+      for( auto id : ids )
+      {
+        auto& node = info.nodes[ id ];
+        auto directory = nodeDirectory + "/node" + std::to_string( id );
+
+        node.logicalCores = detail::parse_cpu_list( detail::read_line( directory + "/cpulist" ) );
+        for( auto cpu : node.logicalCores )
+        {
+          auto package = read_topology_id(
+            systemDirectory_ + "/cpu/cpu" + std::to_string( cpu ) + "/topology/physical_package_id"
+          );
+          node.processorPacks.push_back( package );
+        }
+
+        std::sort( node.processorPacks.begin(), node.processorPacks.end() );
+        node.processorPacks.erase(
+          std::unique( node.processorPacks.begin(), node.processorPacks.end() ), node.processorPacks.end()
+        );
+
+        read_node_memory( directory + "/meminfo", node );
+
+        auto distances = detail::read_line( directory + "/distance" );
+        const char* p = distances.data();
+        const char* end = p + distances.size();
+        while( p != end )
+        {
+          if( ( *p >= '0' ) && ( *p <= '9' ) )
+            node.distances.push_back( static_cast< unsigned >( detail::parse_uint( p, end ) ) );
+          else
+            ++p;
+        }
+      }
+
+      return info;
+    }
+
+
+    // -------------------------------------------------------------------------------------------------------
+
+    numa_info get_numa_info()
+    {
+      return get_numa_info( "/sys/devices/system" );
+    }
+
+
+    // -------------------------------------------------------------------------------------------------------
+
+    void set_thread_affinity( std::thread::native_handle_type thread_, const std::vector< unsigned >& cpus_ )
+    {
+      auto maxCPU = *std::max_element( cpus_.begin(), cpus_.end() );
+
+      // cpu_set_t is limited to CPU_SETSIZE processors, the dynamic set works for any machine
+      cpu_set_t* set = CPU_ALLOC( maxCPU + 1 );
+      if( !set )
+        throw exception( error::internal, ENOMEM );
+
+      auto size = CPU_ALLOC_SIZE( maxCPU + 1 );
+      CPU_ZERO_S( size, set );
+      for( auto cpu : cpus_ )
+        CPU_SET_S( cpu, size, set );
+
+      auto result = ::pthread_setaffinity_np( thread_, size, set );
+      CPU_FREE( set );
+
+      if( result != 0 )
+        throw exception( error::internal, result );
+    }
+
+
+    // -------------------------------------------------------------------------------------------------------
+
+    void set_current_thread_affinity( const std::vector< unsigned >& cpus_ )
+    {
+      set_thread_affinity( ::pthread_self(), cpus_ );
+    }
+
+
+    // -------------------------------------------------------------------------------------------------------
+
+    hugepage_info get_hugepage_info()
+    {
+      // see https://www.kernel.org/doc/html/latest/admin-guide/mm/hugetlbpage.html and transhuge.html
+      static const std::string s_hugepageDirectory = "/sys/kernel/mm/hugepages";
+      static const std::string s_transparentDirectory = "/sys/kernel/mm/transparent_hugepage";
+      static const std::string s_nodeDirectory = "/sys/devices/system/node";
+
+      hugepage_info info;
+
+      auto nodes = detail::list_numbered_entries( s_nodeDirectory, "node" );
+      for( const auto& name : detail::list_directory( s_hugepageDirectory ) )
+      {
+        hugepage_info::pool pool;
+        pool.pageSizeInBytes = parse_hugepage_size( name );
+        if( pool.pageSizeInBytes == 0 )
+          continue;
+
+        auto directory = s_hugepageDirectory + "/" + name;
+        pool.totalPages = detail::read_uint( directory + "/nr_hugepages" );
+        pool.freePages = detail::read_uint( directory + "/free_hugepages" );
+        pool.reservedPages = detail::read_uint( directory + "/resv_hugepages" );
+        pool.surplusPages = detail::read_uint( directory + "/surplus_hugepages" );
+
+        for( auto id : nodes )
+        {
+          auto nodeDirectory = s_nodeDirectory + "/node" + std::to_string( id ) + "/hugepages/" + name;
+
+          hugepage_info::node_pool node;
+          node.nodeId = id;
+          if( !detail::try_read_uint( nodeDirectory + "/nr_hugepages", node.totalPages ) )
+            continue;
+          node.freePages = detail::read_uint( nodeDirectory + "/free_hugepages" );
+          node.surplusPages = detail::read_uint( nodeDirectory + "/surplus_hugepages" );
+          pool.nodes.push_back( node );
+        }
+
+        info.pools.push_back( pool );
+      }
+
+      info.transparentHugepages = read_transparent_hugepage_mode( s_transparentDirectory + "/enabled" );
+      info.transparentHugepageDefrag = read_transparent_hugepage_mode( s_transparentDirectory + "/defrag" );
+      info.transparentHugepageSizeInBytes = detail::read_uint( s_transparentDirectory + "/hpage_pmd_size" );
+
+      add_kb_fields( "/proc/meminfo", { 
+        { "AnonHugePages", &info.anonHugepagesInBytes }, 
+        { "ShmemHugePages", &info.shmemHugepagesInBytes } 
+      } );
+
+      // smaps_rollup exists since linux 4.14, summing up smaps is a lot slower but gives the same result
+      std::initializer_list< kb_field > processFields = { 
+        { "AnonHugePages", &info.processAnonHugepagesInBytes }, 
+        { "ShmemPmdMapped", &info.processShmemHugepagesInBytes } 
+      };
+      if( ::access( "/proc/self/smaps_rollup", R_OK ) == 0 )
+        add_kb_fields( "/proc/self/smaps_rollup", processFields );
+      else
+        add_kb_fields( "/proc/self/smaps", processFields );
+
+      return info;
+    }
+
+
+    // -------------------------------------------------------------------------------------------------------
+
+    std::vector< std::uint64_t > get_page_sizes()
+    {
+      std::vector< std::uint64_t > sizes( 1, static_cast< std::uint64_t >( ::sysconf( _SC_PAGESIZE ) ) );
+      for( const auto& name : detail::list_directory( "/sys/kernel/mm/hugepages" ) )
+      {
+        auto size = parse_hugepage_size( name );
+        if( size > 0 )
+          sizes.push_back( size );
+      }
+
+      return sizes;
+    }
+
+
+    // -------------------------------------------------------------------------------------------------------
+
+    bool get_pressure_info( pressure_resource resource_, pressure_scope scope_, pressure_info& info_ )
+    {
+      static pressure_reader s_reader;
+      return s_reader.read( resource_, scope_, info_ );
+    }
+
+
+    // -------------------------------------------------------------------------------------------------------
+
+    int open_pressure_trigger(
+      pressure_resource resource_,
+      pressure_stall stall_,
+      std::uint64_t thresholdInMicroseconds_,
+      std::uint64_t windowInMicroseconds_,
+      pressure_scope scope_
+    )
+    {
+      // see https://www.kernel.org/doc/html/latest/accounting/psi.html#monitoring-for-pressure-thresholds
+      auto path = get_pressure_path( resource_, scope_ );
+      auto fd = path.empty() ? -1 : ::open( path.c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC );
+      if( fd < 0 )
+        throw exception( error::invalid_request, "psi " + ll::to_string( resource_ ) );
+
+      auto trigger = std::string( ( stall_ == pressure_stall::full ) ? "full " : "some " );
+      trigger += std::to_string( thresholdInMicroseconds_ ) + " " + std::to_string( windowInMicroseconds_ );
+
+      // the kernel expects the terminating zero
+      if( ::write( fd, trigger.c_str(), trigger.size() + 1 ) < 0 )
+      {
+        auto err = errno;
+        ::close( fd );
+        throw exception( ( err == EINVAL ) ? error::invalid_parameter : error::internal, err );
+      }
+
+      return fd;
+    }
+
+
+    // -------------------------------------------------------------------------------------------------------
+
+    void close_pressure_trigger( int handle_ )
+    {
+      ::close( handle_ );
+    }
+
+
+    // -------------------------------------------------------------------------------------------------------
+
+    void wait_for_pressure( 
+      const std::vector< int >& handles_, 
+      int timeoutInMilliseconds_, 
+      std::vector< size_t >& fired_ 
+    )
+    {
+      std::vector< pollfd > fds( handles_.size() );
+      for( size_t i = 0; i < handles_.size(); ++i )
+      {
+        fds[ i ].fd = handles_[ i ];
+        fds[ i ].events = POLLPRI;
+        fds[ i ].revents = 0;
+      }
+
+      int count = 0;
+      do
+      {
+        count = ::poll( fds.data(), fds.size(), timeoutInMilliseconds_ );
+      } while( ( count < 0 ) && ( errno == EINTR ) );
+
+      if( count < 0 )
+        throw exception( error::internal, errno );
+
+      for( size_t i = 0; i < fds.size(); ++i )
+      {
+        // POLLERR if the monitored cgroup has been removed
+        if( fds[ i ].revents & POLLERR )
+          throw exception( error::internal, "pressure trigger is no longer valid" );
+
+        if( fds[ i ].revents & POLLPRI )
+          fired_.push_back( i );
+      }
+    }
+
+
     // -------------------------------------------------------------------------------------------------------
 
     gpu_info get_gpu_info()
@@ -244,20 +1442,18 @@ namespace platform
   
   memory_info get_memory_info()
   {
-    // see http://stackoverflow.com/questions/63166/how-to-determine-cpu-and-memory-consumption-from-inside-a-process
-    // for details
-  
-    memory_info info;
-    auto rawInfo = get_raw_memory_info();
+    // see https://www.kernel.org/doc/Documentation/filesystems/proc.txt for details on the fields
 
-    info.totalPhysicalMemoryInBytes = std::stoll( boost::trim_copy( rawInfo[ "MemTotal" ] ) ) * 1024;
-    info.availablePhysicalMemoryInBytes = std::stoll( boost::trim_copy( rawInfo[ "MemFree" ] ) ) * 1024;
-    
-    info.totalVirtualMemoryInBytes = std::stoll( boost::trim_copy( rawInfo[ "SwapTotal" ] ) ) * 1024;   
-    info.totalVirtualMemoryInBytes += info.totalPhysicalMemoryInBytes;
+    static meminfo_reader s_reader;
+    static cgroup_memory_reader s_cgroupReader;
+
+    memory_info info;
+    if( !s_reader.read( info ) )
+      throw exception( error::internal, "/proc/meminfo" );
 
-    info.availableVirtualMemoryInBytes = std::stoll( boost::trim_copy( rawInfo[ "SwapFree" ] ) ) * 1024; 
-    info.availableVirtualMemoryInBytes += info.availablePhysicalMemoryInBytes;
+    std::uint64_t headroom = 0;
+    s_cgroupReader.read( info.cgroup, headroom );
+    info.effectiveAvailablePhysicalMemoryInBytes = std::min( info.availablePhysicalMemoryInBytes, headroom );
 
     return info;
   }
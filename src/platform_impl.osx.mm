@@ -36,6 +36,7 @@ LL_WARNING_ENABLE_GCC( unused-local-typedef );
 #include <sys/mount.h>
 #include <mach/mach.h>
 #include <mach/vm_statistics.h>
+#include <unistd.h>
 
 
 
@@ -180,14 +181,20 @@ namespace platform
       info.processorPacks.resize( static_cast< size_t >( packageCount ) );
     
       auto logicalCoresPerPhysicalCore = logicalCoreCount / physicalCoreCount;
+      unsigned packID = 0, coreID = 0, logicalID = 0;
       for( auto& p : info.processorPacks )
       {
+        p.id = packID++;
         p.physicalCores.resize( static_cast< size_t >(  physicalCoreCount / info.processorPacks.size() ) );
         for( auto& c : p.physicalCores )
         {
+          c.id = coreID++;
           c.logicalCores.resize( logicalCoresPerPhysicalCore );
           for( auto& l : c.logicalCores )
+          {
+            l.id = logicalID++;  // matches the processor-number used by get_logical_core_by_index
             l.maximumSpeedInMHz = currentCPUFreq;
+          }
         }
       }
     
@@ -235,6 +242,132 @@ namespace platform
     }
   
   
+    // -------------------------------------------------------------------------------------------------------
+
+    cpu_budget get_cpu_budget()
+    {
+      // no affinity masks or cpu quotas on osx, all processors are available
+      return cpu_budget();
+    }
+
+
+    // -------------------------------------------------------------------------------------------------------
+
+    void get_cpu_times( cpu_times& times_ )
+    {
+      natural_t cpuCount = 0;
+      processor_info_array_t cpuInfo = nullptr;
+      mach_msg_type_number_t cpuInfoCount = 0;
+
+      if( host_processor_info(
+        mach_host_self(), PROCESSOR_CPU_LOAD_INFO, &cpuCount, &cpuInfo, &cpuInfoCount ) != KERN_SUCCESS )
+        throw exception( error::internal );
+
+      times_.total = cpu_times::logical_core();
+      times_.logicalCores.resize( cpuCount );
+      for( natural_t i = 0; i < cpuCount; ++i )
+      {
+        auto ticks = reinterpret_cast< processor_cpu_load_info_t >( cpuInfo )[ i ].cpu_ticks;
+        auto& core = times_.logicalCores[ i ];
+        core = cpu_times::logical_core();
+        core.user = ticks[ CPU_STATE_USER ];
+        core.nice = ticks[ CPU_STATE_NICE ];
+        core.system = ticks[ CPU_STATE_SYSTEM ];
+        core.idle = ticks[ CPU_STATE_IDLE ];
+
+        times_.total.user += core.user;
+        times_.total.nice += core.nice;
+        times_.total.system += core.system;
+        times_.total.idle += core.idle;
+      }
+
+      vm_deallocate(
+        mach_task_self(), reinterpret_cast< vm_address_t >( cpuInfo ), cpuInfoCount * sizeof( integer_t )
+      );
+    }
+
+
+    // -------------------------------------------------------------------------------------------------------
+
+    numa_info get_numa_info()
+    {
+      //! \todo read the numa nodes of multi-socket machines, until then the generic single node is used
+      return numa_info();
+    }
+
+
+    // -------------------------------------------------------------------------------------------------------
+
+    void set_thread_affinity( std::thread::native_handle_type, const std::vector< unsigned >& )
+    {
+      // osx only supports affinity tags (hints for sharing caches), threads can't be bound to processors
+      throw exception( error::invalid_request, "thread affinity is not supported on osx" );
+    }
+
+
+    // -------------------------------------------------------------------------------------------------------
+
+    void set_current_thread_affinity( const std::vector< unsigned >& cpus_ )
+    {
+      set_thread_affinity( ::pthread_self(), cpus_ );
+    }
+
+
+    // -------------------------------------------------------------------------------------------------------
+
+    hugepage_info get_hugepage_info()
+    {
+      // osx has no huge page pools, superpages are requested with VM_FLAGS_SUPERPAGE_SIZE_* per mapping
+      return hugepage_info();
+    }
+
+
+    // -------------------------------------------------------------------------------------------------------
+
+    std::vector< std::uint64_t > get_page_sizes()
+    {
+      return std::vector< std::uint64_t >( 1, static_cast< std::uint64_t >( ::getpagesize() ) );
+    }
+
+
+    // -------------------------------------------------------------------------------------------------------
+
+    bool get_pressure_info( pressure_resource, pressure_scope, pressure_info& )
+    {
+      // pressure stall information is linux specific
+      return false;
+    }
+
+
+    // -------------------------------------------------------------------------------------------------------
+
+    int open_pressure_trigger( 
+      pressure_resource resource_, 
+      pressure_stall, 
+      std::uint64_t, 
+      std::uint64_t, 
+      pressure_scope 
+    )
+    {
+      throw exception( error::invalid_request, "psi " + ll::to_string( resource_ ) );
+    }
+
+
+    // -------------------------------------------------------------------------------------------------------
+
+    void close_pressure_trigger( int )
+    {
+    }
+
+
+    // -------------------------------------------------------------------------------------------------------
+
+    void wait_for_pressure( const std::vector< int >&, int, std::vector< size_t >& )
+    {
+      throw exception( error::invalid_request, "pressure stall information" );
+    }
+
+
     // -------------------------------------------------------------------------------------------------------
 
     gpu_info get_gpu_info()
@@ -326,6 +459,7 @@ namespace platform
     std::uint64_t purgeable = vmstat.purgeable_count;
   */
     info.availablePhysicalMemoryInBytes = static_cast< std::uint64_t >( vmstat.free_count ) * pagesize;
+    info.freePhysicalMemoryInBytes = info.availablePhysicalMemoryInBytes;
   
     // get the free space on the root partition => that's the maximum available swap space
     struct statfs stats;
@@ -335,6 +469,9 @@ namespace platform
       info.totalVirtualMemoryInBytes = freeSpaceOnRoot + info.totalPhysicalMemoryInBytes;
       info.availableVirtualMemoryInBytes = info.availablePhysicalMemoryInBytes + freeSpaceOnRoot - swapusage.xsu_used;
     }
+
+    // no cgroups on osx
+    info.effectiveAvailablePhysicalMemoryInBytes = info.availablePhysicalMemoryInBytes;
   
     return info;
   }
@@ -17,6 +17,7 @@
 *************************************************************************************************************/
 
 #include "platform_impl.h"
+#include "systeminfo/exception.h"
 
 #include <base/environment.h>
 #include <base/debug_helpers.h>
@@ -24,6 +25,7 @@
 #include <boost/algorithm/string.hpp>
 
 #include <array>
+#include <mutex>
 #include <vector>
 
 #include <Windows.h>
@@ -49,6 +51,19 @@ namespace
   } PROCESSOR_POWER_INFORMATION, *PPROCESSOR_POWER_INFORMATION;
 
 
+  // winternl.h only declares the structure with reserved members, the layout is the one of the ddk
+  typedef struct _SYSTEM_PROCESSOR_PERFORMANCE_INFORMATION {
+    LARGE_INTEGER IdleTime;
+    LARGE_INTEGER KernelTime;  // includes the idle, dpc and interrupt time
+    LARGE_INTEGER UserTime;
+    LARGE_INTEGER DpcTime;
+    LARGE_INTEGER InterruptTime;
+    ULONG InterruptCount;
+  } SYSTEM_PROCESSOR_PERFORMANCE_INFORMATION, *PSYSTEM_PROCESSOR_PERFORMANCE_INFORMATION;
+
+  const ULONG s_systemProcessorPerformanceInformation = 8;
+
+
   // ---------------------------------------------------------------------------------------------------------
 
   std::string query_registry_string( HKEY& key_, const std::string& valueName_ )
@@ -254,6 +269,41 @@ LL_WARNING_ENABLE_MSVC( 4191 )
           case RelationProcessorCore:
             logicalCoresPerPhysicalCore = count_set_bits( pData->ProcessorMask );
             break;
+
+          case RelationCache:
+          {
+            cpu_info::cache cache;
+            cache.level = pData->Cache.Level;
+            cache.sizeInBytes = pData->Cache.Size;
+            cache.lineSizeInBytes = pData->Cache.LineSize;
+            cache.associativity = ( pData->Cache.Associativity == CACHE_FULLY_ASSOCIATIVE ) 
+              ? 0 : pData->Cache.Associativity;
+
+            switch( pData->Cache.Type )
+            {
+              case CacheData:
+                cache.type = cache_type::data;
+                break;
+              case CacheInstruction:
+                cache.type = cache_type::instruction;
+                break;
+              case CacheUnified:
+                cache.type = cache_type::unified;
+                break;
+              default:
+                break;
+            }
+
+            // the logical core ids correspond to the bits of the processor mask
+            for( unsigned bit = 0; bit < sizeof( pData->ProcessorMask ) * 8; ++bit )
+            {
+              if( pData->ProcessorMask & ( static_cast< ULONG_PTR >( 1 ) << bit ) )
+                cache.logicalCores.push_back( bit );
+            }
+
+            info.caches.push_back( cache );
+            break;
+          }
         
           default:
             break;
@@ -272,6 +322,19 @@ LL_WARNING_ENABLE_MSVC( 4191 )
         }
       }
 
+      // logical processors are enumerated in package / core order
+      unsigned packID = 0, coreID = 0, logicalID = 0;
+      for( auto& p : info.processorPacks )
+      {
+        p.id = packID++;
+        for( auto& c : p.physicalCores )
+        {
+          c.id = coreID++;
+          for( auto& l : c.logicalCores )
+            l.id = logicalID++;
+        }
+      }
+
       return info;
     }
 
@@ -313,6 +376,200 @@ LL_WARNING_ENABLE_MSVC( 4191 )
     }
 
 
+    // -------------------------------------------------------------------------------------------------------
+
+    cpu_budget get_cpu_budget()
+    {
+      //! \todo cpu rate limits of job objects (JobObjectCpuRateControlInformation), processor groups
+      cpu_budget budget;
+
+      DWORD_PTR processMask = 0;
+      DWORD_PTR systemMask = 0;
+      if( ::GetProcessAffinityMask( ::GetCurrentProcess(), &processMask, &systemMask ) )
+      {
+        for( unsigned cpu = 0; cpu < sizeof( processMask ) * 8; ++cpu )
+        {
+          if( processMask & ( static_cast< DWORD_PTR >( 1 ) << cpu ) )
+            budget.allowedLogicalCores.push_back( cpu );
+        }
+      }
+
+      return budget;
+    }
+
+
+    // -------------------------------------------------------------------------------------------------------
+
+    void get_cpu_times( cpu_times& times_ )
+    {
+      times_.total = cpu_times::logical_core();
+
+      FILETIME idle, kernel, user;
+      if( !::GetSystemTimes( &idle, &kernel, &user ) )
+        throw exception( error::internal, static_cast< int >( ::GetLastError() ) );
+
+      auto to_uint64 = []( const FILETIME& t_ )
+      {
+        return ( static_cast< std::uint64_t >( t_.dwHighDateTime ) << 32 ) | t_.dwLowDateTime;
+      };
+
+      // kernel time includes the idle time
+      times_.total.idle = to_uint64( idle );
+      times_.total.system = to_uint64( kernel ) - times_.total.idle;
+      times_.total.user = to_uint64( user );
+
+      typedef LONG( WINAPI* LPFN_NTQSI )( ULONG, PVOID, ULONG, PULONG );
+
+LL_WARNING_DISABLE_MSVC( 4191 )
+      static const LPFN_NTQSI s_query = reinterpret_cast< LPFN_NTQSI >( GetProcAddress( 
+        GetModuleHandle( TEXT( "ntdll" ) ),
+        "NtQuerySystemInformation" 
+      ) );
+LL_WARNING_ENABLE_MSVC( 4191 )
+
+      // sized once, vs2013 has no thread_local
+      static std::mutex s_mutex;
+      static std::vector< SYSTEM_PROCESSOR_PERFORMANCE_INFORMATION > s_cores;
+      std::lock_guard< std::mutex > lock( s_mutex );
+
+      //! \todo processor groups, only the cores of the group of the calling thread are reported
+      if( s_cores.empty() )
+      {
+        SYSTEM_INFO systemInfo;
+        ::GetSystemInfo( &systemInfo );
+        s_cores.resize( systemInfo.dwNumberOfProcessors );
+      }
+
+      auto& cores = s_cores;
+      ULONG size = 0;
+      if( !s_query || ( s_query( 
+        s_systemProcessorPerformanceInformation,
+        cores.data(),
+        static_cast< ULONG >( cores.size() * sizeof( SYSTEM_PROCESSOR_PERFORMANCE_INFORMATION ) ),
+        &size 
+      ) < 0 ) )
+      {
+        times_.logicalCores.clear();
+        return;
+      }
+
+      auto count = size / sizeof( SYSTEM_PROCESSOR_PERFORMANCE_INFORMATION );
+      if( count > cores.size() )
+        count = cores.size();
+      times_.logicalCores.resize( count );
+      for( size_t i = 0; i < count; ++i )
+      {
+        auto& core = times_.logicalCores[ i ];
+        core = cpu_times::logical_core();
+        core.idle = static_cast< std::uint64_t >( cores[ i ].IdleTime.QuadPart );
+        core.irq = static_cast< std::uint64_t >( cores[ i ].InterruptTime.QuadPart );
+        core.softirq = static_cast< std::uint64_t >( cores[ i ].DpcTime.QuadPart );
+        auto kernelTime = static_cast< std::uint64_t >( cores[ i ].KernelTime.QuadPart );
+        auto excluded = core.idle + core.irq + core.softirq;
+        core.system = ( kernelTime > excluded ) ? kernelTime - excluded : 0;
+        core.user = static_cast< std::uint64_t >( cores[ i ].UserTime.QuadPart );
+      }
+    }
+
+
+    // -------------------------------------------------------------------------------------------------------
+
+    numa_info get_numa_info()
+    {
+      //! \todo read the numa nodes of multi-socket machines, until then the generic single node is used
+      return numa_info();
+    }
+
+
+    // -------------------------------------------------------------------------------------------------------
+
+    void set_thread_affinity( std::thread::native_handle_type thread_, const std::vector< unsigned >& cpus_ )
+    {
+      //! \todo processor groups, the affinity mask only covers the first 64 logical processors
+      DWORD_PTR mask = 0;
+      for( auto cpu : cpus_ )
+      {
+        if( cpu >= sizeof( mask ) * 8 )
+          throw exception( error::invalid_parameter, static_cast< int >( cpu ) );
+        mask |= static_cast< DWORD_PTR >( 1 ) << cpu;
+      }
+
+      if( ::SetThreadAffinityMask( static_cast< HANDLE >( thread_ ), mask ) == 0 )
+        throw exception( error::internal, static_cast< int >( ::GetLastError() ) );
+    }
+
+
+    // -------------------------------------------------------------------------------------------------------
+
+    void set_current_thread_affinity( const std::vector< unsigned >& cpus_ )
+    {
+      set_thread_affinity( ::GetCurrentThread(), cpus_ );
+    }
+
+
+    // -------------------------------------------------------------------------------------------------------
+
+    hugepage_info get_hugepage_info()
+    {
+      //! \todo large pages come from the regular memory on demand (SeLockMemoryPrivilege), there is no pool
+      return hugepage_info();
+    }
+
+
+    // -------------------------------------------------------------------------------------------------------
+
+    std::vector< std::uint64_t > get_page_sizes()
+    {
+      SYSTEM_INFO systemInfo;
+      ::GetSystemInfo( &systemInfo );
+
+      std::vector< std::uint64_t > sizes( 1, systemInfo.dwPageSize );
+      auto largePageSize = ::GetLargePageMinimum();
+      if( largePageSize > 0 )
+        sizes.push_back( largePageSize );
+
+      return sizes;
+    }
+
+
+    // -------------------------------------------------------------------------------------------------------
+
+    bool get_pressure_info( pressure_resource, pressure_scope, pressure_info& )
+    {
+      // pressure stall information is linux specific
+      return false;
+    }
+
+
+    // -------------------------------------------------------------------------------------------------------
+
+    int open_pressure_trigger( 
+      pressure_resource resource_, 
+      pressure_stall, 
+      std::uint64_t, 
+      std::uint64_t, 
+      pressure_scope 
+    )
+    {
+      throw exception( error::invalid_request, "psi " + ll::to_string( resource_ ) );
+    }
+
+
+    // -------------------------------------------------------------------------------------------------------
+
+    void close_pressure_trigger( int )
+    {
+    }
+
+
+    // -------------------------------------------------------------------------------------------------------
+
+    void wait_for_pressure( const std::vector< int >&, int, std::vector< size_t >& )
+    {
+      throw exception( error::invalid_request, "pressure stall information" );
+    }
+
+
     // -------------------------------------------------------------------------------------------------------
 
     gpu_info get_gpu_info()
@@ -368,11 +625,15 @@ LL_WARNING_ENABLE_MSVC( 4191 )
       if( ::GlobalMemoryStatusEx ( &memstatus ) )
       {
         info.availablePhysicalMemoryInBytes = memstatus.ullAvailPhys;
+        info.freePhysicalMemoryInBytes = memstatus.ullAvailPhys;
         info.totalVirtualMemoryInBytes = memstatus.ullTotalPageFile;
         info.availableVirtualMemoryInBytes = memstatus.ullAvailPageFile;
       }
     }
 
+    //! \todo job object memory limits (JobObjectExtendedLimitInformation)
+    info.effectiveAvailablePhysicalMemoryInBytes = info.availablePhysicalMemoryInBytes;
+
     return info;
   }
 
@@ -0,0 +1,186 @@
+/*************************************************************************************************************
+
+ Limelight Framework - SystemInfo Utils
+
+
+ Copyright 2016 mvd
+
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in
+ compliance with the License. You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software distributed under the License is
+ distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and limitations under the License.
+
+*************************************************************************************************************/
+
+#include "systeminfo/process.h"
+#include "process_impl.h"
+
+#include <algorithm>
+
+
+namespace ll
+{
+namespace systeminfo
+{
+namespace process
+{
+  namespace
+  {
+    double per_second( std::uint64_t previous_, std::uint64_t current_, double seconds_ )
+    {
+      // counters only go backwards if the snapshots were mixed up
+      return ( current_ > previous_ ) ? static_cast< double >( current_ - previous_ ) / seconds_ : 0.0;
+    }
+
+
+    template< typename value_t >
+    value_t delta( value_t previous_, value_t current_ )
+    {
+      return ( current_ > previous_ ) ? current_ - previous_ : value_t( 0 );
+    }
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  thread_sampler::thread_sampler( scan_context_switches scan_ )
+    : m_reader( impl::create_thread_reader( scan_ ) )
+  {
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  thread_sampler::~thread_sampler()
+  {
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  const std::vector< thread_usage >& thread_sampler::sample()
+  {
+    // the vectors swap roles, so the elements (and their names) of two samples back get reused
+    std::swap( m_threads, m_previousThreads );
+    m_previous = m_current;
+
+    m_current = std::chrono::steady_clock::now();
+    m_reader->read( m_threads );
+
+    auto lessId = []( const thread_usage& t_, std::uint64_t id_ ) { return t_.id < id_; };
+
+    auto previous = m_previousThreads.begin();
+    for( auto& t : m_threads )
+    {
+      previous = std::lower_bound( previous, m_previousThreads.end(), t.id, lessId );
+
+      if( ( previous != m_previousThreads.end() ) && ( previous->id == t.id ) )
+      {
+        t.userTimeDelta = delta( previous->userTime, t.userTime );
+        t.systemTimeDelta = delta( previous->systemTime, t.systemTime );
+        t.voluntaryContextSwitchesDelta = delta( previous->voluntaryContextSwitches, t.voluntaryContextSwitches );
+        t.involuntaryContextSwitchesDelta = 
+          delta( previous->involuntaryContextSwitches, t.involuntaryContextSwitches );
+      }
+      else
+      {
+        t.userTimeDelta = t.userTime;
+        t.systemTimeDelta = t.systemTime;
+        t.voluntaryContextSwitchesDelta = t.voluntaryContextSwitches;
+        t.involuntaryContextSwitchesDelta = t.involuntaryContextSwitches;
+      }
+    }
+
+    return m_threads;
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  resource_usage get_resource_usage( scan_proportional_set scan_ )
+  {
+    resource_usage usage;
+    update_resource_usage( usage, scan_ );
+    return usage;
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  void update_resource_usage( resource_usage& usage_, scan_proportional_set scan_ )
+  {
+    usage_.timestamp = std::chrono::steady_clock::now();
+    impl::update_resource_usage( usage_, scan_ );
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  resource_rates get_resource_rates( const resource_usage& previous_, const resource_usage& current_ )
+  {
+    resource_rates rates;
+
+    auto seconds = std::chrono::duration< double >( current_.timestamp - previous_.timestamp ).count();
+    if( seconds <= 0.0 )
+      return rates;
+
+    auto cpuPercent = [ seconds ]( std::chrono::microseconds from_, std::chrono::microseconds to_ )
+    {
+      auto busy = std::chrono::duration< double >( to_ - from_ ).count();
+      return ( busy > 0.0 ) ? 100.0 * busy / seconds : 0.0;
+    };
+
+    rates.userCpuPercent = cpuPercent( previous_.userTime, current_.userTime );
+    rates.systemCpuPercent = cpuPercent( previous_.systemTime, current_.systemTime );
+
+    rates.minorPageFaultsPerSecond = per_second( previous_.minorPageFaults, current_.minorPageFaults, seconds );
+    rates.majorPageFaultsPerSecond = per_second( previous_.majorPageFaults, current_.majorPageFaults, seconds );
+
+    rates.voluntaryContextSwitchesPerSecond = 
+      per_second( previous_.voluntaryContextSwitches, current_.voluntaryContextSwitches, seconds );
+    rates.involuntaryContextSwitchesPerSecond = 
+      per_second( previous_.involuntaryContextSwitches, current_.involuntaryContextSwitches, seconds );
+
+    rates.residentSetChangeInBytesPerSecond = 
+      ( static_cast< double >( current_.residentSetInBytes ) - static_cast< double >( previous_.residentSetInBytes ) )
+      / seconds;
+
+    return rates;
+  }
+
+}  // namespace process
+}  // namespace systeminfo
+}  // namespace ll
+
+
+
+namespace ll
+{
+  using namespace systeminfo;
+
+  std::string to_string( process::thread_state s_ )
+  {
+    switch ( s_ )
+    {
+    case process::thread_state::running:
+      return "Running";
+    case process::thread_state::sleeping:
+      return "Sleeping";
+    case process::thread_state::disk_sleep:
+      return "Disk Sleep";
+    case process::thread_state::stopped:
+      return "Stopped";
+    case process::thread_state::zombie:
+      return "Zombie";
+    case process::thread_state::idle:
+      return "Idle";
+    default:
+      return "Unknown";
+    }
+  }
+
+} // namespace ll
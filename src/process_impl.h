@@ -0,0 +1,83 @@
+/*************************************************************************************************************
+
+ Limelight Framework - SystemInfo Utils
+
+
+ Copyright 2016 mvd
+
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in
+ compliance with the License. You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software distributed under the License is
+ distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and limitations under the License.
+
+*************************************************************************************************************/
+
+#pragma once
+
+#include "systeminfo/counters.h"
+#include "systeminfo/process.h"
+
+
+namespace ll
+{
+namespace systeminfo
+{
+namespace process
+{  
+  
+  namespace impl
+  {
+    //! fills everything but the timestamp
+    void update_resource_usage( resource_usage& usage_, scan_proportional_set scan_ );
+
+
+    //! the platform specific part of the thread_sampler
+    class thread_reader
+    {
+    public:
+      virtual ~thread_reader() = default;
+
+      //! fills the accumulated values of the threads ordered by id, reusing the elements of threads_
+      virtual void read( std::vector< thread_usage >& threads_ ) = 0;
+    };
+
+    std::unique_ptr< thread_reader > create_thread_reader( scan_context_switches scan_ );
+
+
+    //! the platform specific part of the counter_group
+    class counter_reader
+    {
+    public:
+      using event_set = std::bitset< static_cast< size_t >( counter_event::count ) >;
+
+      virtual ~counter_reader() = default;
+
+      virtual void enable() = 0;
+      virtual void disable() = 0;
+      virtual void reset() = 0;
+
+      //! must not throw, it's called by the destructor of counter_scope
+      virtual void read( counter_values& values_ ) = 0;
+
+      const event_set& available() const { return m_available; }
+
+    protected:
+      event_set m_available;
+    };
+
+    //! throws invalid_request if none of the events can be counted
+    std::unique_ptr< counter_reader > create_counter_reader( 
+      counter_target target_, 
+      unsigned cpu_, 
+      const std::vector< counter_event >& events_ 
+    );
+
+  }  // namespace impl
+
+}  // namespace process
+}  // namespace systeminfo
+}  // namespace ll
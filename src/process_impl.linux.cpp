@@ -0,0 +1,809 @@
+/*************************************************************************************************************
+
+ Limelight Framework - SystemInfo Utils
+
+
+ Copyright 2016 mvd
+
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in
+ compliance with the License. You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software distributed under the License is
+ distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and limitations under the License.
+
+*************************************************************************************************************/
+
+#include "systeminfo/exception.h"
+#include "process_impl.h"
+#include "file_utils.linux.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <mutex>
+
+#include <dirent.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+
+namespace ll
+{
+namespace systeminfo
+{
+namespace process
+{
+  namespace
+  {
+    template< size_t N >
+    bool starts_with( const char* p_, const char* end_, const char ( &prefix_ )[ N ] )
+    {
+      return ( static_cast< size_t >( end_ - p_ ) >= N - 1 ) && ( std::memcmp( p_, prefix_, N - 1 ) == 0 );
+    }
+
+
+    //! keeps the /proc/self files open, so a refresh neither opens files nor allocates; /proc/self is
+    //! resolved when a file is opened, so a child process reopens them after a fork
+    class usage_reader
+    {
+    public:
+      usage_reader() 
+        : m_pageSize( static_cast< std::uint64_t >( ::sysconf( _SC_PAGESIZE ) ) )
+      {
+        open_files();
+      }
+
+      ~usage_reader()
+      {
+        if( m_fdDirectory )
+          ::closedir( m_fdDirectory );
+      }
+
+      usage_reader( const usage_reader& ) = delete;
+      usage_reader& operator=( const usage_reader& ) = delete;
+
+      void read( resource_usage& usage_, scan_proportional_set scan_ )
+      {
+        std::lock_guard< std::mutex > lock( m_mutex );
+
+        if( ::getpid() != m_pid )
+          open_files();
+
+        read_rusage( usage_ );
+        read_statm( usage_ );
+        read_status( usage_ );
+        usage_.openFileDescriptors = count_file_descriptors();
+
+        usage_.proportionalSetInBytes = 0;
+        if( scan_ == scan_proportional_set::include )
+          usage_.proportionalSetInBytes = read_proportional_set();
+      }
+
+    private:
+      void open_files()
+      {
+        m_pid = ::getpid();
+        m_statm.open( "/proc/self/statm" );
+        m_status.open( "/proc/self/status" );
+        m_smapsRollup.close();
+
+        if( m_fdDirectory )
+          ::closedir( m_fdDirectory );
+        m_fdDirectory = ::opendir( "/proc/self/fd" );
+      }
+
+
+      static void read_rusage( resource_usage& usage_ )
+      {
+        struct rusage usage;
+        if( ::getrusage( RUSAGE_SELF, &usage ) != 0 )
+          return;
+
+        auto to_microseconds = []( const timeval& t_ ) 
+        { 
+          return std::chrono::microseconds( static_cast< std::int64_t >( t_.tv_sec ) * 1000000 + t_.tv_usec ); 
+        };
+
+        usage_.userTime = to_microseconds( usage.ru_utime );
+        usage_.systemTime = to_microseconds( usage.ru_stime );
+        usage_.minorPageFaults = static_cast< std::uint64_t >( usage.ru_minflt );
+        usage_.majorPageFaults = static_cast< std::uint64_t >( usage.ru_majflt );
+        usage_.voluntaryContextSwitches = static_cast< std::uint64_t >( usage.ru_nvcsw );
+        usage_.involuntaryContextSwitches = static_cast< std::uint64_t >( usage.ru_nivcsw );
+      }
+
+
+      //! size resident shared text lib data dt, in pages
+      void read_statm( resource_usage& usage_ )
+      {
+        if( !m_statm.read() )
+          return;
+
+        const char* p = m_statm.data();
+        usage_.virtualMemoryInBytes = detail::parse_uint( p, m_statm.end() ) * m_pageSize;
+        usage_.residentSetInBytes = detail::parse_uint( p, m_statm.end() ) * m_pageSize;
+      }
+
+
+      void read_status( resource_usage& usage_ )
+      {
+        if( !m_status.read() )
+          return;
+
+        const char* p = m_status.data();
+        const char* end = m_status.end();
+        while( p != end )
+        {
+          if( starts_with( p, end, "VmHWM:" ) )
+          {
+            p += 6;
+            usage_.peakResidentSetInBytes = detail::parse_uint( p, end ) * 1024;
+          }
+          else if( starts_with( p, end, "Threads:" ) )
+          {
+            p += 8;
+            usage_.threadCount = static_cast< unsigned >( detail::parse_uint( p, end ) );
+          }
+
+          detail::skip_line( p, end );
+        }
+      }
+
+
+      unsigned count_file_descriptors()
+      {
+        if( !m_fdDirectory )
+          return 0;
+
+        ::rewinddir( m_fdDirectory );
+
+        unsigned count = 0;
+        while( struct dirent* entry = ::readdir( m_fdDirectory ) )
+        {
+          if( entry->d_name[ 0 ] != '.' )
+            ++count;
+        }
+
+        // the descriptor of the directory stream itself
+        return ( count > 0 ) ? count - 1 : 0;
+      }
+
+
+      std::uint64_t read_proportional_set()
+      {
+        // smaps_rollup exists since linux 4.14
+        if( !m_smapsRollup.is_open() && !m_smapsRollup.open( "/proc/self/smaps_rollup" ) )
+          return 0;
+
+        if( !m_smapsRollup.read() )
+          return 0;
+
+        const char* p = m_smapsRollup.data();
+        const char* end = m_smapsRollup.end();
+        while( p != end )
+        {
+          if( starts_with( p, end, "Pss:" ) )
+          {
+            p += 4;
+            return detail::parse_uint( p, end ) * 1024;
+          }
+
+          detail::skip_line( p, end );
+        }
+
+        return 0;
+      }
+
+
+      std::mutex m_mutex;  // the reader is shared by all callers of update_resource_usage
+      pid_t m_pid = 0;     // of the process that opened the files
+      detail::proc_file m_statm;
+      detail::proc_file m_status;
+      detail::proc_file m_smapsRollup;
+      DIR* m_fdDirectory = nullptr;
+      std::uint64_t m_pageSize = 4096;
+    };
+
+
+    thread_state to_thread_state( char state_ )
+    {
+      switch( state_ )
+      {
+        case 'R':
+          return thread_state::running;
+        case 'S':
+          return thread_state::sleeping;
+        case 'D':
+          return thread_state::disk_sleep;
+        case 'T':
+        case 't':
+          return thread_state::stopped;
+        case 'Z':
+        case 'X':
+          return thread_state::zombie;
+        case 'I':
+          return thread_state::idle;
+        default:
+          return thread_state::unknown;
+      }
+    }
+
+
+    //! keeps /proc/self/task and the stat and status files of every thread open; the directory is only
+    //! listed again if the number of threads changes or a thread can't be read, all files are reopened after
+    //! a fork
+    class task_reader : public impl::thread_reader
+    {
+    public:
+      explicit task_reader( scan_context_switches scan_ )
+        : m_scan( scan_ )
+        , m_ticksPerSecond( static_cast< std::uint64_t >( std::max( ::sysconf( _SC_CLK_TCK ), 1l ) ) )
+      {
+        open_process();
+      }
+
+      ~task_reader()
+      {
+        if( m_taskDirectory )
+          ::closedir( m_taskDirectory );
+      }
+
+      void read( std::vector< thread_usage >& threads_ ) override
+      {
+        if( ::getpid() != m_pid )
+          open_process();
+
+        bool listed = false;
+        if( m_files.empty() || ( read_thread_count() != m_files.size() ) )
+        {
+          list_threads();
+          update_files();
+          listed = true;
+        }
+
+        // a thread that exited, possibly replaced by a new one with the same count, or even the same id
+        if( !read_threads( threads_ ) && !listed )
+        {
+          list_threads();
+          update_files();
+          read_threads( threads_ );
+        }
+      }
+
+    private:
+      struct task_files
+      {
+        std::uint64_t id;
+        detail::proc_file stat;
+        detail::proc_file status;
+        detail::proc_file schedstat;
+        std::uint64_t runTime = 0;  // in nanoseconds, from schedstat when stat was read last
+        thread_usage usage;         // the values of stat as of runTime
+      };
+
+
+      void list_threads()
+      {
+        m_ids.clear();
+        if( !m_taskDirectory )
+          return;
+
+        ::rewinddir( m_taskDirectory );
+        while( struct dirent* entry = ::readdir( m_taskDirectory ) )
+        {
+          const char* p = entry->d_name;
+          if( ( *p >= '0' ) && ( *p <= '9' ) )
+            m_ids.push_back( detail::parse_uint( p, p + std::strlen( p ) ) );
+        }
+
+        std::sort( m_ids.begin(), m_ids.end() );
+      }
+
+
+      //! the thread files are opened again by the next listing
+      void open_process()
+      {
+        m_pid = ::getpid();
+        m_processStat.open( "/proc/self/stat" );
+        m_files.clear();
+
+        if( m_taskDirectory )
+          ::closedir( m_taskDirectory );
+        m_taskDirectory = ::opendir( "/proc/self/task" );
+      }
+
+
+      //! the num_threads field of /proc/self/stat, 0 if it can't be read
+      size_t read_thread_count()
+      {
+        if( !m_processStat.read_once() )
+          return 0;
+
+        const char* p = std::strrchr( m_processStat.data(), ')' );
+        if( !p )
+          return 0;
+
+        // the state after the name is field 3, num_threads is field 20
+        const char* end = m_processStat.end();
+        for( unsigned field = 3; ( field <= 20 ) && ( p != end ); ++field )
+        {
+          ++p;
+          while( ( p != end ) && ( *p != ' ' ) )
+            ++p;
+        }
+
+        return static_cast< size_t >( detail::parse_uint( p, end ) );
+      }
+
+
+      //! returns false if a thread couldn't be read even after reopening its files, it's left out
+      bool read_threads( std::vector< thread_usage >& threads_ )
+      {
+        threads_.resize( m_files.size() );
+
+        bool complete = true;
+        size_t count = 0;
+        for( auto& f : m_files )
+        {
+          auto& t = threads_[ count ];
+          t.id = f.id;
+
+          // the files of an exited thread fail with ESRCH, even if its id got reused; and the first open
+          // may have lost the race against the start of the thread
+          if( !read_thread( f, t ) && ( !open_files( f ) || !read_thread( f, t ) ) )
+          {
+            complete = false;
+            continue;
+          }
+
+          ++count;
+        }
+
+        threads_.resize( count );
+        return complete;
+      }
+
+
+      //! stat is much more expensive to read than schedstat, and none of its values change unless the thread
+      //! runs; without schedstat (or schedstats disabled) the run time is 0 and stat is read every time
+      bool read_thread( task_files& files_, thread_usage& thread_ )
+      {
+        auto runTime = read_run_time( files_.schedstat );
+        if( ( runTime == 0 ) || ( runTime != files_.runTime ) )
+        {
+          if( !read_stat( files_.stat, files_.usage ) )
+            return false;
+          files_.runTime = runTime;
+        }
+
+        thread_.name = files_.usage.name;
+        thread_.state = files_.usage.state;
+        thread_.lastProcessor = files_.usage.lastProcessor;
+        thread_.userTime = files_.usage.userTime;
+        thread_.systemTime = files_.usage.systemTime;
+
+        return ( m_scan == scan_context_switches::exclude ) || read_status( files_.status, thread_ );
+      }
+
+
+      bool open_files( task_files& files_ )
+      {
+        auto directory = "/proc/self/task/" + std::to_string( files_.id );
+        files_.runTime = 0;
+        files_.schedstat.open( directory + "/schedstat" );
+        if( !files_.stat.open( directory + "/stat" ) )
+          return false;
+
+        return ( m_scan == scan_context_switches::exclude ) || files_.status.open( directory + "/status" );
+      }
+
+
+      //! closes the files of threads that are gone and opens the ones of new threads, ordered by id
+      void update_files()
+      {
+        m_files.erase( 
+          std::remove_if( m_files.begin(), m_files.end(), [this]( const task_files& f_ ) 
+          { 
+            return !std::binary_search( m_ids.begin(), m_ids.end(), f_.id ); 
+          } ),
+          m_files.end()
+        );
+
+        auto known = m_files.size();
+        for( auto id : m_ids )
+        {
+          auto lessId = []( const task_files& f_, std::uint64_t id_ ) { return f_.id < id_; };
+          auto it = std::lower_bound( m_files.begin(), m_files.begin() + known, id, lessId );
+          if( ( it != m_files.begin() + known ) && ( it->id == id ) )
+            continue;
+
+          task_files f;
+          f.id = id;
+          open_files( f );
+          m_files.push_back( std::move( f ) );
+        }
+
+        if( m_files.size() != known )
+        {
+          std::sort( m_files.begin(), m_files.end(), []( const task_files& lhs_, const task_files& rhs_ ) 
+          { 
+            return lhs_.id < rhs_.id; 
+          } );
+        }
+      }
+
+
+      //! tid (comm) state ppid ..., see proc(5) for the field numbers
+      bool read_stat( detail::proc_file& file_, thread_usage& thread_ )
+      {
+        if( !file_.read_once() )
+          return false;
+
+        // the name may contain spaces and parentheses itself
+        const char* begin = std::strchr( file_.data(), '(' );
+        const char* last = std::strrchr( file_.data(), ')' );
+        if( !begin || !last || ( last < begin ) )
+          return false;
+
+        thread_.name.assign( begin + 1, last );
+
+        const char* p = last + 1;
+        const char* end = file_.end();
+        auto skip_blanks = [&p, end]()
+        {
+          while( ( p != end ) && ( *p == ' ' ) )
+            ++p;
+        };
+        auto skip_field = [&p, end]()
+        {
+          while( ( p != end ) && ( *p != ' ' ) )
+            ++p;
+        };
+
+        skip_blanks();
+        thread_.state = ( p != end ) ? to_thread_state( *p ) : thread_state::unknown;
+
+        // the state is field 3
+        std::uint64_t utime = 0, stime = 0;
+        for( unsigned field = 4; ( field <= 39 ) && ( p != end ); ++field )
+        {
+          skip_field();
+          skip_blanks();
+
+          if( field == 14 )
+            utime = detail::parse_uint( p, end );
+          else if( field == 15 )
+            stime = detail::parse_uint( p, end );
+          else if( field == 39 )
+            thread_.lastProcessor = static_cast< unsigned >( detail::parse_uint( p, end ) );
+        }
+
+        thread_.userTime = std::chrono::microseconds( utime * 1000000 / m_ticksPerSecond );
+        thread_.systemTime = std::chrono::microseconds( stime * 1000000 / m_ticksPerSecond );
+        return true;
+      }
+
+
+      //! the first field of schedstat, the time the thread spent on a cpu; 0 if it can't be read
+      static std::uint64_t read_run_time( detail::proc_file& file_ )
+      {
+        if( !file_.is_open() || !file_.read_once() )
+          return 0;
+
+        const char* p = file_.data();
+        return detail::parse_uint( p, file_.end() );
+      }
+
+
+      static bool read_status( detail::proc_file& file_, thread_usage& thread_ )
+      {
+        if( !file_.read_once() )
+          return false;
+
+        const char* p = file_.data();
+        const char* end = file_.end();
+        while( p != end )
+        {
+          if( starts_with( p, end, "voluntary_ctxt_switches:" ) )
+          {
+            p += 24;
+            thread_.voluntaryContextSwitches = detail::parse_uint( p, end );
+          }
+          else if( starts_with( p, end, "nonvoluntary_ctxt_switches:" ) )
+          {
+            p += 27;
+            thread_.involuntaryContextSwitches = detail::parse_uint( p, end );
+          }
+
+          detail::skip_line( p, end );
+        }
+
+        return true;
+      }
+
+
+      scan_context_switches m_scan;
+      pid_t m_pid = 0;  // of the process that opened the files
+      detail::proc_file m_processStat;
+      DIR* m_taskDirectory = nullptr;
+      std::uint64_t m_ticksPerSecond = 100;
+      std::vector< std::uint64_t > m_ids;
+      std::vector< task_files > m_files;  // ordered by id
+    };
+
+
+    struct perf_event
+    {
+      std::uint32_t type;
+      std::uint64_t config;
+      size_t group;  // events whose ratio is of interest share a group, so they are always counted together
+    };
+
+
+    perf_event to_perf_event( counter_event e_ )
+    {
+      switch( e_ )
+      {
+        case counter_event::cycles:
+          return { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, 0 };
+        case counter_event::instructions:
+          return { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, 0 };
+        case counter_event::cache_references:
+          return { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES, 1 };
+        case counter_event::cache_misses:
+          return { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, 1 };
+        case counter_event::branches:
+          return { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_INSTRUCTIONS, 2 };
+        case counter_event::branch_misses:
+          return { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, 2 };
+        case counter_event::task_clock:
+          return { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK, 3 };
+        case counter_event::context_switches:
+          return { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES, 3 };
+        case counter_event::page_faults:
+        default:
+          return { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS, 3 };
+      }
+    }
+
+
+    //! opens up to four perf event groups: the hardware events in pairs (so a pmu with few counters can
+    //! multiplex them without breaking the ratios) and the software events; a process counter opens them
+    //! for every thread that exists and inherits them to the threads created afterwards
+    class perf_counter_reader : public impl::counter_reader
+    {
+    public:
+      perf_counter_reader( 
+        counter_target target_, 
+        unsigned cpu_, 
+        const std::vector< counter_event >& events_ 
+      )
+      {
+        int pid = ( target_ == counter_target::cpu ) ? -1 : 0;
+        int cpu = ( target_ == counter_target::cpu ) ? static_cast< int >( cpu_ ) : -1;
+
+        m_tasks.emplace_back();
+        int err = open_task( m_tasks.back(), target_, pid, cpu, events_ );
+        if( m_available.none() )
+          throw exception( error::invalid_request, "perf_event_open " + std::string( std::strerror( err ) ) );
+
+        if( target_ == counter_target::process )
+        {
+          // the other threads only get the events the creating thread could open, a thread that exits in
+          // between just fails to open (ESRCH)
+          std::vector< counter_event > available;
+          for( auto e : events_ )
+          {
+            if( m_available.test( static_cast< size_t >( e ) ) )
+              available.push_back( e );
+          }
+
+          auto self = static_cast< unsigned >( ::syscall( SYS_gettid ) );
+          for( auto id : detail::list_numbered_entries( "/proc/self/task", "" ) )
+          {
+            if( id == self )
+              continue;
+
+            m_tasks.emplace_back();
+            open_task( m_tasks.back(), target_, static_cast< int >( id ), cpu, available );
+          }
+        }
+
+        reset();
+        enable();
+      }
+
+      ~perf_counter_reader()
+      {
+        for( const auto& task : m_tasks )
+          for( const auto& group : task )
+            for( auto fd : group.fds )
+              ::close( fd );
+      }
+
+      perf_counter_reader( const perf_counter_reader& ) = delete;
+      perf_counter_reader& operator=( const perf_counter_reader& ) = delete;
+
+      void enable() override
+      {
+        control( PERF_EVENT_IOC_ENABLE );
+      }
+
+      void disable() override
+      {
+        control( PERF_EVENT_IOC_DISABLE );
+      }
+
+      void reset() override
+      {
+        control( PERF_EVENT_IOC_RESET );
+      }
+
+      void read( counter_values& values_ ) override
+      {
+        values_.values.fill( 0 );
+        values_.available = m_available;
+        values_.timeEnabled = std::chrono::nanoseconds( 0 );
+        values_.timeRunning = std::chrono::nanoseconds( 0 );
+
+        bool first = true;
+        for( size_t t = 0; t < m_tasks.size(); ++t )
+        {
+          for( const auto& group : m_tasks[ t ] )
+          {
+            if( group.leader < 0 )
+              continue;
+
+            // nr, time_enabled, time_running and one value per event, see PERF_FORMAT_GROUP
+            std::array< std::uint64_t, 3 + static_cast< size_t >( counter_event::count ) > buffer;
+            auto size = ( 3 + group.events.size() ) * sizeof( std::uint64_t );
+            if( ::read( group.leader, buffer.data(), size ) != static_cast< ssize_t >( size ) )
+              continue;
+
+            auto enabled = buffer[ 1 ];
+            auto running = buffer[ 2 ];
+            for( size_t i = 0; ( i < group.events.size() ) && ( i < buffer[ 0 ] ); ++i )
+            {
+              // extrapolate if the group had to share the counters with other groups
+              auto value = buffer[ 3 + i ];
+              if( running == 0 )
+                value = 0;
+              else if( running < enabled )
+                value = static_cast< std::uint64_t >( static_cast< double >( value ) * enabled / running );
+
+              values_.values[ static_cast< size_t >( group.events[ i ] ) ] += value;
+            }
+
+            // report the group of the creating thread that was multiplexed the most, the times of the
+            // other threads stop when they exit
+            if( t != 0 )
+              continue;
+
+            auto timeEnabled = std::chrono::nanoseconds( enabled );
+            auto timeRunning = std::chrono::nanoseconds( running );
+            values_.timeEnabled = first ? timeEnabled : std::max( values_.timeEnabled, timeEnabled );
+            values_.timeRunning = first ? timeRunning : std::min( values_.timeRunning, timeRunning );
+            first = false;
+          }
+        }
+      }
+
+    private:
+      struct group
+      {
+        int leader = -1;
+        std::vector< int > fds;
+        std::vector< counter_event > events;  // in the order they were added, the order of the read
+      };
+
+      typedef std::array< group, 4 > task;
+
+      //! returns the errno of the last event that couldn't be opened
+      int open_task( 
+        task& task_, 
+        counter_target target_, 
+        int pid_, 
+        int cpu_, 
+        const std::vector< counter_event >& events_ 
+      )
+      {
+        int err = 0;
+        event_set opened;
+        for( auto e : events_ )
+        {
+          if( opened.test( static_cast< size_t >( e ) ) )
+            continue;
+
+          auto event = to_perf_event( e );
+          auto& group = task_[ event.group ];
+
+          perf_event_attr attr;
+          std::memset( &attr, 0, sizeof( attr ) );
+          attr.size = sizeof( attr );
+          attr.type = event.type;
+          attr.config = event.config;
+          attr.read_format = 
+            PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+          attr.disabled = ( group.leader < 0 ) ? 1 : 0;  // the members follow their leader
+          attr.inherit = ( target_ == counter_target::process ) ? 1 : 0;
+
+          // counting the kernel requires perf_event_paranoid < 2 (a system wide counter needs < 1 anyway),
+          // the software events are counted by the kernel itself, excluding it would hide context switches
+          bool userOnly = ( event.type == PERF_TYPE_HARDWARE ) && ( target_ != counter_target::cpu );
+          attr.exclude_kernel = userOnly ? 1 : 0;
+          attr.exclude_hv = 1;
+
+          int fd = static_cast< int >( 
+            ::syscall( SYS_perf_event_open, &attr, pid_, cpu_, group.leader, PERF_FLAG_FD_CLOEXEC ) 
+          );
+          if( fd < 0 )
+          {
+            // e.g. ENOENT for hardware events in a virtual machine, EACCES due to perf_event_paranoid
+            err = errno;
+            continue;
+          }
+
+          if( group.leader < 0 )
+            group.leader = fd;
+          group.fds.push_back( fd );
+          group.events.push_back( e );
+          opened.set( static_cast< size_t >( e ) );
+        }
+
+        m_available |= opened;
+        return err;
+      }
+
+      void control( unsigned long request_ )
+      {
+        for( const auto& task : m_tasks )
+        {
+          for( const auto& group : task )
+          {
+            if( group.leader >= 0 )
+              ::ioctl( group.leader, request_, PERF_IOC_FLAG_GROUP );
+          }
+        }
+      }
+
+      std::vector< task > m_tasks;  // the creating thread (or the cpu) first
+    };
+  }
+
+
+  namespace impl
+  {
+    void update_resource_usage( resource_usage& usage_, scan_proportional_set scan_ )
+    {
+      // read() locks, concurrent callers don't share the buffers of the files
+      static usage_reader s_reader;
+      s_reader.read( usage_, scan_ );
+    }
+
+
+    std::unique_ptr< thread_reader > create_thread_reader( scan_context_switches scan_ )
+    {
+      return std::unique_ptr< thread_reader >( new task_reader( scan_ ) );
+    }
+
+
+    std::unique_ptr< counter_reader > create_counter_reader( 
+      counter_target target_, 
+      unsigned cpu_, 
+      const std::vector< counter_event >& events_ 
+    )
+    {
+      return std::unique_ptr< counter_reader >( new perf_counter_reader( target_, cpu_, events_ ) );
+    }
+
+  }  // namespace impl
+
+}  // namespace process
+}  // namespace systeminfo
+}  // namespace ll
@@ -0,0 +1,203 @@
+/*************************************************************************************************************
+
+ Limelight Framework - SystemInfo Utils
+
+
+ Copyright 2016 mvd
+
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in
+ compliance with the License. You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software distributed under the License is
+ distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and limitations under the License.
+
+*************************************************************************************************************/
+
+#include "systeminfo/exception.h"
+#include "process_impl.h"
+
+#include <algorithm>
+
+#include <libproc.h>
+#include <mach/mach.h>
+#include <pthread.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+
+namespace ll
+{
+namespace systeminfo
+{
+namespace process
+{
+  namespace
+  {
+    std::chrono::microseconds to_microseconds( const timeval& t_ )
+    {
+      return std::chrono::microseconds( static_cast< std::int64_t >( t_.tv_sec ) * 1000000 + t_.tv_usec );
+    }
+
+
+    std::chrono::microseconds to_microseconds( const time_value_t& t_ )
+    {
+      return std::chrono::microseconds( static_cast< std::int64_t >( t_.seconds ) * 1000000 + t_.microseconds );
+    }
+
+
+    thread_state to_thread_state( integer_t state_ )
+    {
+      switch( state_ )
+      {
+        case TH_STATE_RUNNING:
+          return thread_state::running;
+        case TH_STATE_WAITING:
+          return thread_state::sleeping;
+        case TH_STATE_UNINTERRUPTIBLE:
+          return thread_state::disk_sleep;
+        case TH_STATE_STOPPED:
+          return thread_state::stopped;
+        case TH_STATE_HALTED:
+          return thread_state::zombie;
+        default:
+          return thread_state::unknown;
+      }
+    }
+
+
+    class mach_thread_reader : public impl::thread_reader
+    {
+    public:
+      void read( std::vector< thread_usage >& threads_ ) override
+      {
+        //! \todo the last processor and context switches aren't available through the mach api
+        thread_act_array_t threads = nullptr;
+        mach_msg_type_number_t threadCount = 0;
+        if( ::task_threads( ::mach_task_self(), &threads, &threadCount ) != KERN_SUCCESS )
+        {
+          threads_.clear();
+          return;
+        }
+
+        threads_.resize( threadCount );
+
+        size_t count = 0;
+        for( mach_msg_type_number_t i = 0; i < threadCount; ++i )
+        {
+          auto& t = threads_[ count ];
+
+          thread_identifier_info_data_t identifier;
+          mach_msg_type_number_t size = THREAD_IDENTIFIER_INFO_COUNT;
+          auto identifierInfo = reinterpret_cast< thread_info_t >( &identifier );
+          if( ::thread_info( threads[ i ], THREAD_IDENTIFIER_INFO, identifierInfo, &size ) == KERN_SUCCESS )
+          {
+            thread_basic_info_data_t basic;
+            size = THREAD_BASIC_INFO_COUNT;
+            auto basicInfo = reinterpret_cast< thread_info_t >( &basic );
+            if( ::thread_info( threads[ i ], THREAD_BASIC_INFO, basicInfo, &size ) == KERN_SUCCESS )
+            {
+              t.id = identifier.thread_id;
+              t.state = to_thread_state( basic.run_state );
+              t.userTime = to_microseconds( basic.user_time );
+              t.systemTime = to_microseconds( basic.system_time );
+
+              char name[ 64 ] = { 0 };
+              auto thread = ::pthread_from_mach_thread_np( threads[ i ] );
+              if( thread )
+                ::pthread_getname_np( thread, name, sizeof( name ) );
+              t.name = name;
+
+              ++count;
+            }
+          }
+
+          ::mach_port_deallocate( ::mach_task_self(), threads[ i ] );
+        }
+
+        ::vm_deallocate( 
+          ::mach_task_self(), 
+          reinterpret_cast< vm_address_t >( threads ), 
+          threadCount * sizeof( thread_act_t ) 
+        );
+
+        threads_.resize( count );
+        std::sort( threads_.begin(), threads_.end(), []( const thread_usage& lhs_, const thread_usage& rhs_ ) 
+        { 
+          return lhs_.id < rhs_.id; 
+        } );
+      }
+    };
+  }
+
+
+  namespace impl
+  {
+    void update_resource_usage( resource_usage& usage_, scan_proportional_set )
+    {
+      struct rusage usage;
+      if( ::getrusage( RUSAGE_SELF, &usage ) == 0 )
+      {
+        usage_.userTime = to_microseconds( usage.ru_utime );
+        usage_.systemTime = to_microseconds( usage.ru_stime );
+        usage_.minorPageFaults = static_cast< std::uint64_t >( usage.ru_minflt );
+        usage_.majorPageFaults = static_cast< std::uint64_t >( usage.ru_majflt );
+        usage_.voluntaryContextSwitches = static_cast< std::uint64_t >( usage.ru_nvcsw );
+        usage_.involuntaryContextSwitches = static_cast< std::uint64_t >( usage.ru_nivcsw );
+      }
+
+      mach_task_basic_info_data_t info;
+      mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+      if( ::task_info( ::mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast< task_info_t >( &info ), &count ) 
+        == KERN_SUCCESS )
+      {
+        usage_.residentSetInBytes = info.resident_size;
+        usage_.peakResidentSetInBytes = info.resident_size_max;
+        usage_.virtualMemoryInBytes = info.virtual_size;
+      }
+
+      thread_act_array_t threads = nullptr;
+      mach_msg_type_number_t threadCount = 0;
+      if( ::task_threads( ::mach_task_self(), &threads, &threadCount ) == KERN_SUCCESS )
+      {
+        usage_.threadCount = threadCount;
+
+        for( mach_msg_type_number_t i = 0; i < threadCount; ++i )
+          ::mach_port_deallocate( ::mach_task_self(), threads[ i ] );
+        ::vm_deallocate( 
+          ::mach_task_self(), 
+          reinterpret_cast< vm_address_t >( threads ), 
+          threadCount * sizeof( thread_act_t ) 
+        );
+      }
+
+      // without a buffer the size of the descriptor table in use is returned
+      auto size = ::proc_pidinfo( ::getpid(), PROC_PIDLISTFDS, 0, nullptr, 0 );
+      if( size > 0 )
+        usage_.openFileDescriptors = static_cast< unsigned >( size / PROC_PIDLISTFD_SIZE );
+    }
+
+
+    std::unique_ptr< thread_reader > create_thread_reader( scan_context_switches )
+    {
+      return std::unique_ptr< thread_reader >( new mach_thread_reader() );
+    }
+
+
+    std::unique_ptr< counter_reader > create_counter_reader( 
+      counter_target, 
+      unsigned, 
+      const std::vector< counter_event >& 
+    )
+    {
+      //! \todo the kperf framework is private and requires root
+      throw exception( error::invalid_request, "perf events" );
+    }
+
+  }  // namespace impl
+
+}  // namespace process
+}  // namespace systeminfo
+}  // namespace ll
@@ -0,0 +1,149 @@
+/*************************************************************************************************************
+
+ Limelight Framework - SystemInfo Utils
+
+
+ Copyright 2016 mvd
+
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in
+ compliance with the License. You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software distributed under the License is
+ distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and limitations under the License.
+
+*************************************************************************************************************/
+
+#include "systeminfo/exception.h"
+#include "process_impl.h"
+
+#include <algorithm>
+
+#include <Windows.h>
+#include <Psapi.h>
+#include <TlHelp32.h>
+
+
+namespace ll
+{
+namespace systeminfo
+{
+namespace process
+{
+  namespace
+  {
+    std::chrono::microseconds to_microseconds( const FILETIME& t_ )
+    {
+      // in units of 100ns
+      auto ticks = ( static_cast< std::uint64_t >( t_.dwHighDateTime ) << 32 ) | t_.dwLowDateTime;
+      return std::chrono::microseconds( ticks / 10 );
+    }
+
+
+    class toolhelp_thread_reader : public impl::thread_reader
+    {
+    public:
+      void read( std::vector< thread_usage >& threads_ ) override
+      {
+        //! \todo names (GetThreadDescription), states and context switches (NtQuerySystemInformation)
+        threads_.clear();
+
+        // the snapshot contains the threads of all processes
+        HANDLE snapshot = ::CreateToolhelp32Snapshot( TH32CS_SNAPTHREAD, 0 );
+        if( snapshot == INVALID_HANDLE_VALUE )
+          return;
+
+        auto processId = ::GetCurrentProcessId();
+
+        THREADENTRY32 entry;
+        entry.dwSize = sizeof( entry );
+        auto found = ::Thread32First( snapshot, &entry );
+        for( ; found; found = ::Thread32Next( snapshot, &entry ) )
+        {
+          if( entry.th32OwnerProcessID != processId )
+            continue;
+
+          HANDLE thread = ::OpenThread( THREAD_QUERY_LIMITED_INFORMATION, FALSE, entry.th32ThreadID );
+          if( !thread )
+            continue;
+
+          thread_usage t;
+          t.id = entry.th32ThreadID;
+          t.lastProcessor = 0;
+
+          FILETIME creation, exit, kernel, user;
+          if( ::GetThreadTimes( thread, &creation, &exit, &kernel, &user ) )
+          {
+            t.userTime = to_microseconds( user );
+            t.systemTime = to_microseconds( kernel );
+          }
+
+          ::CloseHandle( thread );
+          threads_.push_back( t );
+        }
+
+        ::CloseHandle( snapshot );
+
+        std::sort( threads_.begin(), threads_.end(), []( const thread_usage& lhs_, const thread_usage& rhs_ ) 
+        { 
+          return lhs_.id < rhs_.id; 
+        } );
+      }
+    };
+  }
+
+
+  namespace impl
+  {
+    void update_resource_usage( resource_usage& usage_, scan_proportional_set )
+    {
+      //! \todo thread count and context switches (NtQuerySystemInformation with SystemProcessInformation)
+      auto process = ::GetCurrentProcess();
+
+      PROCESS_MEMORY_COUNTERS_EX counters;
+      counters.cb = sizeof( counters );
+      auto countersPtr = reinterpret_cast< PROCESS_MEMORY_COUNTERS* >( &counters );
+      if( ::GetProcessMemoryInfo( process, countersPtr, sizeof( counters ) ) )
+      {
+        usage_.residentSetInBytes = counters.WorkingSetSize;
+        usage_.peakResidentSetInBytes = counters.PeakWorkingSetSize;
+        usage_.virtualMemoryInBytes = counters.PrivateUsage;
+        usage_.minorPageFaults = counters.PageFaultCount;  // soft and hard faults aren't reported separately
+      }
+
+      FILETIME creation, exit, kernel, user;
+      if( ::GetProcessTimes( process, &creation, &exit, &kernel, &user ) )
+      {
+        usage_.userTime = to_microseconds( user );
+        usage_.systemTime = to_microseconds( kernel );
+      }
+
+      DWORD handles = 0;
+      if( ::GetProcessHandleCount( process, &handles ) )
+        usage_.openFileDescriptors = static_cast< unsigned >( handles );
+    }
+
+
+    std::unique_ptr< thread_reader > create_thread_reader( scan_context_switches )
+    {
+      return std::unique_ptr< thread_reader >( new toolhelp_thread_reader() );
+    }
+
+
+    std::unique_ptr< counter_reader > create_counter_reader( 
+      counter_target, 
+      unsigned, 
+      const std::vector< counter_event >& 
+    )
+    {
+      //! \todo etw provides hardware counters through TracePmcCounterListInfo
+      throw exception( error::invalid_request, "perf events" );
+    }
+
+  }  // namespace impl
+
+}  // namespace process
+}  // namespace systeminfo
+}  // namespace ll
@@ -17,6 +17,1107 @@
 *************************************************************************************************************/
 
 #include "systeminfo/storage.h"
+#include "systeminfo/exception.h"
+#include "storage_impl.h"
+
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
+
+
+namespace ll
+{
+namespace systeminfo
+{
+namespace storage
+{
+  namespace
+  {
+    std::uint64_t device_key( unsigned major_, unsigned minor_ )
+    {
+      return ( static_cast< std::uint64_t >( major_ ) << 32 ) | minor_;
+    }
+
+
+    bool less_device( const device_io& lhs_, const device_io& rhs_ )
+    {
+      return device_key( lhs_.major, lhs_.minor ) < device_key( rhs_.major, rhs_.minor );
+    }
+
+
+    bool is_separator( char c_ )
+    {
+#if defined( _WIN32 )
+      return ( c_ == '/' ) || ( c_ == '\\' );
+#else
+      return c_ == '/';
+#endif
+    }
+
+
+    //! moves p_ behind the next element of a path, "." is skipped; false at the end of the path
+    bool next_element( const char*& p_, const char* end_, const char*& element_, size_t& size_ )
+    {
+      for( ;; )
+      {
+        while( ( p_ != end_ ) && is_separator( *p_ ) )
+          ++p_;
+        if( p_ == end_ )
+          return false;
+
+        element_ = p_;
+        while( ( p_ != end_ ) && !is_separator( *p_ ) )
+          ++p_;
+
+        size_ = static_cast< size_t >( p_ - element_ );
+        if( ( size_ != 1 ) || ( *element_ != '.' ) )
+          return true;
+      }
+    }
+
+
+    using trie_children = std::vector< std::pair< std::string, std::uint32_t > >;
+
+    //! compares the names of the children to an element of a path without copying it
+    struct element_less
+    {
+      using element = std::pair< const char*, size_t >;
+
+      bool operator()( const trie_children::value_type& child_, const element& e_ ) const
+      {
+        return child_.first.compare( 0, std::string::npos, e_.first, e_.second ) < 0;
+      }
+    };
+
+
+    trie_children::const_iterator find_child( 
+      const trie_children& children_, 
+      const char* name_, 
+      size_t size_ 
+    )
+    {
+      auto it = std::lower_bound( 
+        children_.begin(), children_.end(), std::make_pair( name_, size_ ), element_less() 
+      );
+
+      if( ( it == children_.end() ) || ( it->first.compare( 0, std::string::npos, name_, size_ ) != 0 ) )
+        return children_.end();
+
+      return it;
+    }
+
+
+    double to_microseconds( std::uint64_t nanoseconds_ )
+    {
+      return static_cast< double >( nanoseconds_ ) / 1000.0;
+    }
+
+
+    double per_second( std::uint64_t previous_, std::uint64_t current_, double seconds_ )
+    {
+      return ( current_ > previous_ ) ? static_cast< double >( current_ - previous_ ) / seconds_ : 0.0;
+    }
+
+
+    //! the average time per request, the counters of a device are reset when it's re-attached
+    double average( 
+      std::chrono::milliseconds previousTime_, 
+      std::chrono::milliseconds currentTime_, 
+      std::uint64_t previousCount_, 
+      std::uint64_t currentCount_ 
+    )
+    {
+      if( ( currentCount_ <= previousCount_ ) || ( currentTime_ < previousTime_ ) )
+        return 0.0;
+
+      auto time = static_cast< double >( ( currentTime_ - previousTime_ ).count() );
+      return time / static_cast< double >( currentCount_ - previousCount_ );
+    }
+
+
+    double share( std::chrono::milliseconds previous_, std::chrono::milliseconds current_, double seconds_ )
+    {
+      if( current_ < previous_ )
+        return 0.0;
+
+      return std::chrono::duration< double >( current_ - previous_ ).count() / seconds_;
+    }
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  storage_info get_storage_info( scan_network_storage scan_ )
+  {
+    storage_query query;
+    query.scan = scan_;
+    return get_storage_info( query );
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  std::vector< filesystem_info > get_filesystems( scan_network_storage scan_ )
+  {
+    storage_query query;
+    query.scan = scan_;
+    return get_filesystems( query );
+  }
+
+
+  namespace impl
+  {
+    const storage_info::volume* find_owning_volume( const storage_info& info_, const fs::path& path_ )
+    {
+      const storage_info::volume* result = nullptr;
+      size_t resultLength = 0;
+
+      for( const auto& v : info_.volumes )
+      {
+        // compared element wise, so /data doesn't contain /database
+        size_t length = 0;
+        auto element = v.path.begin();
+        auto p = path_.begin();
+        for( ; ( element != v.path.end() ) && ( p != path_.end() ) && ( *element == *p ); ++element, ++p )
+          ++length;
+
+        if( ( element == v.path.end() ) && ( !result || ( length > resultLength ) ) )
+        {
+          result = &v;
+          resultLength = length;
+        }
+      }
+
+      return result;
+    }
+
+
+    latency_distribution summarize_latencies( std::vector< std::uint32_t >& latencies_ )
+    {
+      latency_distribution result;
+      if( latencies_.empty() )
+        return result;
+
+      std::sort( latencies_.begin(), latencies_.end() );
+
+      auto percentile = [&latencies_]( double p_ )
+      {
+        auto index = static_cast< size_t >( p_ * static_cast< double >( latencies_.size() - 1 ) + 0.5 );
+        return to_microseconds( latencies_[ index ] );
+      };
+
+      std::uint64_t sum = 0;
+      for( auto l : latencies_ )
+        sum += l;
+
+      result.minimum = to_microseconds( latencies_.front() );
+      result.mean = to_microseconds( sum ) / static_cast< double >( latencies_.size() );
+      result.p50 = percentile( 0.5 );
+      result.p90 = percentile( 0.9 );
+      result.p99 = percentile( 0.99 );
+      result.p999 = percentile( 0.999 );
+      result.maximum = to_microseconds( latencies_.back() );
+      return result;
+    }
+
+
+    //! shared with the threads, so the callback isn't called after the canary has been destroyed
+    struct canary_callback
+    {
+      std::mutex mutex;
+      bool stopped = false;
+      std::function< void( const canary_status& ) > function;
+      std::atomic< std::thread::id > caller{ std::thread::id() };  // the thread in function, holds the mutex
+    };
+
+
+    //! the state of one volume, owned by the canary and its thread; the mutex is never held during a read
+    struct canary_volume
+    {
+      canary_options options;
+      std::shared_ptr< canary_callback > callback;
+
+      mutable std::mutex mutex;
+      std::condition_variable stop;
+      bool stopped = false;
+
+      canary_status status;
+      std::vector< std::uint32_t > window;  // a ring buffer of the last latencies in nanoseconds
+      size_t next = 0;
+      bool reportedSlow = false;  // the state of the last callback
+      std::chrono::steady_clock::time_point readStarted;  // the epoch if there's no outstanding read
+
+      //! the status including a read that is still outstanding, requires the mutex
+      canary_status current() const
+      {
+        auto result = status;
+        if( readStarted != std::chrono::steady_clock::time_point() )
+        {
+          result.stalled = std::chrono::steady_clock::now() - readStarted > options.p99Threshold;
+          result.slow = result.slow || result.stalled;
+        }
+        return result;
+      }
+    };
+
+
+    void notify( canary_volume& volume_, const canary_status& status_ )
+    {
+      auto& callback = *volume_.callback;
+      std::lock_guard< std::mutex > lock( callback.mutex );
+      if( callback.stopped || !callback.function )
+        return;
+
+      callback.caller = std::this_thread::get_id();
+      callback.function( status_ );
+      callback.caller = std::thread::id();
+    }
+
+
+    //! the thread of a volume, it holds its own reference to the state so it can outlive the canary
+    void run_canary( std::shared_ptr< canary_volume > volume_ )
+    {
+      auto& v = *volume_;
+      int error = 0;
+      auto file = open_canary_file( v.status.file, v.options.createFile, error );
+      {
+        std::lock_guard< std::mutex > lock( v.mutex );
+        v.status.active = file != nullptr;
+        v.status.lastError = error;
+        if( !file )
+          return;
+      }
+
+      std::vector< std::uint32_t > sorted;
+      auto due = std::chrono::steady_clock::now();
+      for( ;; )
+      {
+        {
+          std::unique_lock< std::mutex > lock( v.mutex );
+          if( v.stop.wait_until( lock, due, [&v]() { return v.stopped; } ) )
+            return;
+
+          v.readStarted = std::chrono::steady_clock::now();
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        error = file->read();
+        auto stop = std::chrono::steady_clock::now();
+
+        canary_status changed;
+        bool report = false;
+        {
+          std::lock_guard< std::mutex > lock( v.mutex );
+          v.readStarted = std::chrono::steady_clock::time_point();
+
+          if( error != 0 )
+          {
+            ++v.status.failures;
+            v.status.lastError = error;
+          }
+          else
+          {
+            auto ns = std::chrono::duration_cast< std::chrono::nanoseconds >( stop - start ).count();
+            auto latency = static_cast< std::uint32_t >( std::min< std::int64_t >( ns, UINT32_MAX ) );
+            if( v.window.size() < v.options.windowSize )
+              v.window.push_back( latency );
+            else
+              v.window[ v.next ] = latency;
+            v.next = ( v.next + 1 ) % v.options.windowSize;
+            ++v.status.reads;
+
+            sorted.assign( v.window.begin(), v.window.end() );
+            v.status.latency = summarize_latencies( sorted );
+
+            auto threshold = std::chrono::duration< double, std::micro >( v.options.p99Threshold ).count();
+            v.status.slow = ( v.window.size() >= v.options.minimumSamples ) && 
+                            ( v.status.latency.p99 > threshold );
+          }
+
+          changed = v.status;
+          report = changed.slow != v.reportedSlow;
+          v.reportedSlow = changed.slow;
+        }
+
+        if( report )
+          notify( v, changed );
+
+        // a slow read delays the next one instead of queueing several
+        due += v.options.interval;
+        if( due < stop )
+          due = stop + v.options.interval;
+      }
+    }
+
+
+    //! a volume watched by a space_watcher, only changed by the timer thread once it's registered
+    struct space_watch
+    {
+      storage_info::volume volume;
+      space_watermarks watermarks;
+      space_watcher::callback callback;
+
+      bool checked = false;
+      bool rated = false;
+      space_level level = space_level::normal;
+      double fillRate = 0.0;
+      std::uint64_t previousAvailable = 0;
+      std::chrono::steady_clock::time_point previousCheck;
+      std::chrono::milliseconds interval{ 0 };
+      std::chrono::steady_clock::time_point due;
+      space_event last;
+    };
+
+
+    //! the watches of one space_watcher, shared with the timer thread
+    struct space_watches
+    {
+      space_options options;
+      std::vector< std::shared_ptr< space_watch > > watches;  // guarded by the mutex of the timer
+
+      std::mutex callbackMutex;  // held while a callback runs
+      bool stopped = false;      // guarded by callbackMutex
+      std::atomic< std::thread::id > caller{ std::thread::id() };  // the thread in a callback
+    };
+
+  }  // namespace impl
+
+
+  namespace
+  {
+    //! the thread that checks the watches of all space_watchers
+    struct space_timer
+    {
+      std::mutex mutex;
+      std::condition_variable changed;
+      std::vector< std::shared_ptr< impl::space_watches > > watchers;
+      bool running = false;  // the thread ends when there's nothing left to watch
+    };
+
+
+    space_timer& get_space_timer()
+    {
+      // never destroyed, the thread may still be waiting for a query when the process exits
+      static space_timer* s_timer = new space_timer();
+      return *s_timer;
+    }
+
+
+    //! a level is entered as soon as its watermark is crossed, but only left hysteresis above it
+    space_level next_level( 
+      std::uint64_t available_, 
+      const space_watermarks& watermarks_, 
+      space_level current_ 
+    )
+    {
+      auto level = space_level::normal;
+      if( available_ < watermarks_.criticalInBytes )
+        level = space_level::critical;
+      else if( available_ < watermarks_.lowInBytes )
+        level = space_level::low;
+
+      if( level >= current_ )
+        return level;
+
+      auto margin = watermarks_.hysteresisInBytes;
+      if( ( current_ == space_level::critical ) && ( available_ < watermarks_.criticalInBytes + margin ) )
+        return space_level::critical;
+      if( available_ < watermarks_.lowInBytes + margin )
+        return space_level::low;
+
+      return level;
+    }
+
+
+    //! a quarter of the time until the next watermark is reached at the current fill rate, backs off
+    //! exponentially while the volume doesn't fill up
+    std::chrono::milliseconds next_interval( const impl::space_watch& watch_, const space_options& options_ )
+    {
+      if( watch_.fillRate <= 0.0 )
+        return std::min( watch_.interval * 2, options_.maximumInterval );
+
+      auto available = watch_.previousAvailable;
+      std::uint64_t target = 0;
+      if( watch_.level == space_level::normal )
+        target = watch_.watermarks.lowInBytes;
+      else if( watch_.level == space_level::low )
+        target = watch_.watermarks.criticalInBytes;
+
+      auto distance = ( available > target ) ? static_cast< double >( available - target ) : 0.0;
+      auto milliseconds = distance / watch_.fillRate * 1000.0 / 4.0;
+      if( milliseconds >= static_cast< double >( options_.maximumInterval.count() ) )
+        return options_.maximumInterval;
+
+      auto interval = std::chrono::milliseconds( static_cast< std::int64_t >( milliseconds ) );
+      return std::max( interval, options_.minimumInterval );
+    }
+
+
+    //! updates the watch with a new capacity, returns true if the callback has to be called
+    bool check_space( 
+      impl::space_watch& watch_, 
+      const storage_info::volume& volume_, 
+      std::chrono::steady_clock::time_point now_, 
+      const space_options& options_ 
+    )
+    {
+      auto available = volume_.availableSizeInBytes;
+      if( watch_.checked )
+      {
+        auto seconds = std::chrono::duration< double >( now_ - watch_.previousCheck ).count();
+        if( seconds > 0.0 )
+        {
+          // smoothed, a single large write shouldn't make the next checks much more frequent
+          auto freed = static_cast< double >( available ) - static_cast< double >( watch_.previousAvailable );
+          auto rate = -freed / seconds;
+          watch_.fillRate = watch_.rated ? ( watch_.fillRate + rate ) / 2.0 : rate;
+          watch_.rated = true;
+        }
+      }
+
+      auto level = next_level( available, watch_.watermarks, watch_.level );
+      bool notify = ( level != watch_.level );
+
+      watch_.last.volume = volume_;
+      watch_.last.previousLevel = watch_.level;
+      watch_.last.level = level;
+      watch_.last.fillRateInBytesPerSecond = watch_.fillRate;
+      watch_.last.secondsUntilFull = 0.0;
+      if( watch_.fillRate > 0.0 )
+        watch_.last.secondsUntilFull = static_cast< double >( available ) / watch_.fillRate;
+
+      watch_.checked = true;
+      watch_.level = level;
+      watch_.volume = volume_;
+      watch_.previousAvailable = available;
+      watch_.previousCheck = now_;
+      watch_.interval = next_interval( watch_, options_ );
+      watch_.due = now_ + watch_.interval;
+      return notify;
+    }
+
+
+    void run_space_timer()
+    {
+      auto& timer = get_space_timer();
+
+      struct due_watch
+      {
+        std::shared_ptr< impl::space_watches > watcher;
+        std::shared_ptr< impl::space_watch > watch;
+      };
+
+      std::vector< due_watch > due;
+      std::vector< storage_info::volume > volumes;
+
+      std::unique_lock< std::mutex > lock( timer.mutex );
+      for( ;; )
+      {
+        if( timer.watchers.empty() )
+        {
+          timer.running = false;
+          return;
+        }
+
+        due.clear();
+        volumes.clear();
+        auto now = std::chrono::steady_clock::now();
+        auto next = std::chrono::steady_clock::time_point::max();
+        storage_query query;
+        for( const auto& watcher : timer.watchers )
+        {
+          for( const auto& w : watcher->watches )
+          {
+            if( w->due > now )
+            {
+              next = std::min( next, w->due );
+              continue;
+            }
+
+            due.push_back( due_watch{ watcher, w } );
+            volumes.push_back( w->volume );
+            query.timeout = ( due.size() == 1 ) ? watcher->options.timeout 
+                                                : std::min( query.timeout, watcher->options.timeout );
+          }
+        }
+
+        if( due.empty() )
+        {
+          if( next == std::chrono::steady_clock::time_point::max() )
+            timer.changed.wait( lock );
+          else
+            timer.changed.wait_until( lock, next );
+          continue;
+        }
+
+        // all volumes that are due are queried in one go, without blocking watch() and status()
+        lock.unlock();
+        auto usable = impl::update_capacities( volumes, query );
+        now = std::chrono::steady_clock::now();
+        lock.lock();
+
+        for( size_t i = 0; i < due.size(); ++i )
+        {
+          auto& watcher = *due[ i ].watcher;
+          auto& w = *due[ i ].watch;
+
+          // e.g. replaced by another watch() of the same path while it was queried
+          auto& watches = watcher.watches;
+          if( std::find( watches.begin(), watches.end(), due[ i ].watch ) == watches.end() )
+            continue;
+
+          // an unresponsive volume is retried after the same interval, it keeps its last level
+          if( !usable[ i ] || ( volumes[ i ].capacity != capacity_state::current ) )
+          {
+            w.due = now + std::max( w.interval, watcher.options.minimumInterval );
+            continue;
+          }
+
+          if( !check_space( w, volumes[ i ], now, watcher.options ) || !w.callback )
+            continue;
+
+          auto event = w.last;
+          auto callback = w.callback;
+          lock.unlock();
+          {
+            std::lock_guard< std::mutex > callbackLock( watcher.callbackMutex );
+            if( !watcher.stopped )
+            {
+              watcher.caller = std::this_thread::get_id();
+              callback( event );
+              watcher.caller = std::thread::id();
+            }
+          }
+          lock.lock();
+        }
+      }
+    }
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  io_sampler::io_sampler()
+    : m_reader( impl::create_io_reader() )
+  {
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  io_sampler::~io_sampler()
+  {
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  const std::vector< device_io >& io_sampler::sample()
+  {
+    // the vectors swap roles, so the elements (and their names) of two samples back get reused
+    std::swap( m_devices, m_previousDevices );
+    m_previous = m_current;
+
+    m_current = std::chrono::steady_clock::now();
+    m_reader->read( m_devices );
+
+    auto seconds = std::chrono::duration< double >( m_current - m_previous ).count();
+    auto previous = m_previousDevices.begin();
+    for( auto& d : m_devices )
+    {
+      previous = std::lower_bound( previous, m_previousDevices.end(), d, less_device );
+
+      if( ( previous == m_previousDevices.end() ) || less_device( d, *previous ) || ( seconds <= 0.0 ) )
+      {
+        d.readsPerSecond = d.writesPerSecond = 0.0;
+        d.readBytesPerSecond = d.writeBytesPerSecond = 0.0;
+        d.averageReadLatencyInMilliseconds = d.averageWriteLatencyInMilliseconds = 0.0;
+        d.averageQueueDepth = d.utilizationPercent = 0.0;
+        continue;
+      }
+
+      d.readsPerSecond = per_second( previous->reads, d.reads, seconds );
+      d.writesPerSecond = per_second( previous->writes, d.writes, seconds );
+      d.readBytesPerSecond = per_second( previous->readBytes, d.readBytes, seconds );
+      d.writeBytesPerSecond = per_second( previous->writeBytes, d.writeBytes, seconds );
+      d.averageReadLatencyInMilliseconds = 
+        average( previous->readTime, d.readTime, previous->reads, d.reads );
+      d.averageWriteLatencyInMilliseconds = 
+        average( previous->writeTime, d.writeTime, previous->writes, d.writes );
+      d.averageQueueDepth = share( previous->weightedIoTime, d.weightedIoTime, seconds );
+      d.utilizationPercent = std::min( 100.0, share( previous->ioTime, d.ioTime, seconds ) * 100.0 );
+    }
+
+    return m_devices;
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  const device_io* io_sampler::find( const storage_info::volume& volume_ ) const
+  {
+    if( ( volume_.deviceMajor == 0 ) && ( volume_.deviceMinor == 0 ) )
+      return nullptr;
+
+    auto key = device_key( volume_.deviceMajor, volume_.deviceMinor );
+    auto lessKey = []( const device_io& d_, std::uint64_t key_ ) 
+    { 
+      return device_key( d_.major, d_.minor ) < key_; 
+    };
+    auto it = std::lower_bound( m_devices.begin(), m_devices.end(), key, lessKey );
+
+    bool found = ( it != m_devices.end() ) && ( device_key( it->major, it->minor ) == key );
+    return found ? &*it : nullptr;
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  mount_watcher::mount_watcher( scan_network_storage scan_ )
+    : m_reader( impl::create_mount_reader( scan_ ) )
+  {
+    m_reader->update( m_info, m_events );
+    m_events.clear();
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  mount_watcher::~mount_watcher()
+  {
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  const std::vector< volume_event >& mount_watcher::update( std::chrono::milliseconds timeout_ )
+  {
+    m_events.clear();
+    if( m_reader->wait( timeout_ ) )
+      m_reader->update( m_info, m_events );
+
+    return m_events;
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  const std::vector< volume_event >& mount_watcher::refresh()
+  {
+    m_events.clear();
+    m_reader->update( m_info, m_events );
+    return m_events;
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  int mount_watcher::native_handle() const
+  {
+    return m_reader->native_handle();
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  volume_resolver::volume_resolver( scan_network_storage scan_ )
+    : m_info( get_storage_info( scan_ ) )
+  {
+    build();
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  volume_resolver::volume_resolver( storage_info info_ )
+    : m_info( std::move( info_ ) )
+  {
+    build();
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  const storage_info::volume* volume_resolver::resolve( const fs::path& path_ ) const
+  {
+    // a reference to the native string on posix, so there's no allocation
+    const auto& path = path_.string();
+    return resolve( path.data(), path.data() + path.size() );
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  const storage_info::volume* volume_resolver::resolve( const char* begin_, const char* end_ ) const
+  {
+    auto mount = find_mount( begin_, end_ );
+    if( !mount || ( mount->volume < 0 ) )
+      return nullptr;
+
+    return &m_info.volumes[ static_cast< size_t >( mount->volume ) ];
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  void volume_resolver::resolve( 
+    const std::vector< fs::path >& paths_, 
+    std::vector< const storage_info::volume* >& volumes_ 
+  ) const
+  {
+    volumes_.resize( paths_.size() );
+    for( size_t i = 0; i < paths_.size(); ++i )
+      volumes_[ i ] = resolve( paths_[ i ] );
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  void volume_resolver::build()
+  {
+    m_nodes.assign( 1, node() );
+    auto mounts = impl::read_mount_table();
+
+    // the file system of a volume is the one mounted on its path last, the first volume of a device wins
+    std::map< std::uint64_t, std::int32_t > deviceVolumes;
+    std::vector< bool > mounted( m_info.volumes.size(), false );
+    for( size_t v = 0; v < m_info.volumes.size(); ++v )
+    {
+      auto path = m_info.volumes[ v ].path.string();
+      for( auto m = mounts.rbegin(); m != mounts.rend(); ++m )
+      {
+        if( m->path != path )
+          continue;
+
+        deviceVolumes.emplace( m->device, static_cast< std::int32_t >( v ) );
+        mounted[ v ] = true;
+        break;
+      }
+    }
+
+    // parents are listed before their children, so the upper directory of an overlay is already known
+    for( const auto& m : mounts )
+    {
+      std::int32_t volume = -1;
+      auto device = deviceVolumes.find( m.device );
+      if( device != deviceVolumes.end() )
+        volume = device->second;
+      else if( !m.upperDirectory.empty() )
+      {
+        auto upper = find_mount( m.upperDirectory.data(), m.upperDirectory.data() + m.upperDirectory.size() );
+        volume = upper ? upper->volume : -1;
+      }
+
+      auto& n = m_nodes[ insert( m.path ) ];
+      n.mountPoint = true;
+      n.volume = volume;
+    }
+
+    // e.g. volumes that have been unmounted since info_ was created
+    for( size_t v = 0; v < m_info.volumes.size(); ++v )
+    {
+      if( mounted[ v ] )
+        continue;
+
+      auto& n = m_nodes[ insert( m_info.volumes[ v ].path.string() ) ];
+      if( !n.mountPoint )
+      {
+        n.mountPoint = true;
+        n.volume = static_cast< std::int32_t >( v );
+      }
+    }
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  std::uint32_t volume_resolver::insert( const std::string& path_ )
+  {
+    std::uint32_t index = 0;
+
+    const char* p = path_.data();
+    const char* end = p + path_.size();
+    const char* element = nullptr;
+    size_t size = 0;
+    while( next_element( p, end, element, size ) )
+    {
+      // m_nodes may grow, so there are no references into it
+      const auto& children = m_nodes[ index ].children;
+      auto child = find_child( children, element, size );
+      if( child != children.end() )
+      {
+        index = child->second;
+        continue;
+      }
+
+      auto position = std::upper_bound( 
+        children.begin(), 
+        children.end(), 
+        std::make_pair( std::string( element, size ), std::uint32_t( 0 ) ) 
+      ) - children.begin();
+
+      auto created = static_cast< std::uint32_t >( m_nodes.size() );
+      m_nodes[ index ].children.insert( 
+        m_nodes[ index ].children.begin() + position, 
+        std::make_pair( std::string( element, size ), created ) 
+      );
+      m_nodes.emplace_back();
+      index = created;
+    }
+
+    return index;
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  const volume_resolver::node* volume_resolver::find_mount( const char* begin_, const char* end_ ) const
+  {
+#if !defined( _WIN32 )
+    if( ( begin_ == end_ ) || ( *begin_ != '/' ) )
+      return nullptr;
+#endif
+
+    const node* current = &m_nodes.front();
+    const node* mount = current->mountPoint ? current : nullptr;
+
+    const char* element = nullptr;
+    size_t size = 0;
+    while( next_element( begin_, end_, element, size ) )
+    {
+      auto child = find_child( current->children, element, size );
+      if( child == current->children.end() )
+        break;
+
+      current = &m_nodes[ child->second ];
+      if( current->mountPoint )
+        mount = current;
+    }
+
+    return mount;
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  space_watcher::space_watcher( const space_options& options_ )
+    : m_watches( std::make_shared< impl::space_watches >() )
+  {
+    m_watches->options = options_;
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  space_watcher::~space_watcher()
+  {
+    auto& timer = get_space_timer();
+    {
+      std::lock_guard< std::mutex > lock( timer.mutex );
+      timer.watchers.erase( 
+        std::remove( timer.watchers.begin(), timer.watchers.end(), m_watches ), 
+        timer.watchers.end() 
+      );
+      timer.changed.notify_one();
+    }
+
+    if( m_watches->caller.load() == std::this_thread::get_id() )
+    {
+      // called from a callback, the timer thread holds the mutex
+      m_watches->stopped = true;
+      return;
+    }
+
+    std::lock_guard< std::mutex > lock( m_watches->callbackMutex );
+    m_watches->stopped = true;
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  void space_watcher::watch( 
+    const storage_info::volume& volume_, 
+    const space_watermarks& watermarks_, 
+    callback callback_ 
+  )
+  {
+    auto w = std::make_shared< impl::space_watch >();
+    w->volume = volume_;
+    w->watermarks = watermarks_;
+    w->callback = std::move( callback_ );
+    w->interval = m_watches->options.minimumInterval;
+    w->due = std::chrono::steady_clock::now();
+
+    auto& timer = get_space_timer();
+    std::lock_guard< std::mutex > lock( timer.mutex );
+
+    auto& watches = m_watches->watches;
+    auto existing = std::find_if( 
+      watches.begin(), 
+      watches.end(), 
+      [&volume_]( const std::shared_ptr< impl::space_watch >& w_ ) { return w_->volume.path == volume_.path; }
+    );
+
+    if( existing != watches.end() )
+      *existing = w;
+    else
+      watches.push_back( w );
+
+    if( std::find( timer.watchers.begin(), timer.watchers.end(), m_watches ) == timer.watchers.end() )
+      timer.watchers.push_back( m_watches );
+
+    if( !timer.running )
+    {
+      timer.running = true;
+      std::thread( run_space_timer ).detach();
+    }
+
+    timer.changed.notify_one();
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  void space_watcher::unwatch( const fs::path& path_ )
+  {
+    auto& timer = get_space_timer();
+    std::lock_guard< std::mutex > lock( timer.mutex );
+
+    auto& watches = m_watches->watches;
+    watches.erase( 
+      std::remove_if( 
+        watches.begin(), 
+        watches.end(), 
+        [&path_]( const std::shared_ptr< impl::space_watch >& w_ ) { return w_->volume.path == path_; } 
+      ), 
+      watches.end() 
+    );
+
+    if( watches.empty() )
+    {
+      timer.watchers.erase( 
+        std::remove( timer.watchers.begin(), timer.watchers.end(), m_watches ), 
+        timer.watchers.end() 
+      );
+      timer.changed.notify_one();
+    }
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  std::vector< space_event > space_watcher::status() const
+  {
+    std::vector< space_event > result;
+
+    auto& timer = get_space_timer();
+    std::lock_guard< std::mutex > lock( timer.mutex );
+    for( const auto& w : m_watches->watches )
+    {
+      if( w->checked )
+        result.push_back( w->last );
+    }
+
+    return result;
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  latency_canary::latency_canary( 
+    const std::vector< canary_target >& targets_, 
+    const canary_options& options_ 
+  )
+    : m_callback( std::make_shared< impl::canary_callback >() )
+  {
+    if( ( options_.windowSize == 0 ) || ( options_.interval.count() <= 0 ) )
+      throw exception( error::invalid_parameter, "latency canary" );
+
+    m_callback->function = options_.onChange;
+
+    for( const auto& t : targets_ )
+    {
+      if( !t.file.is_absolute() )
+        throw exception( error::invalid_parameter, t.file.string() );
+    }
+
+    for( const auto& t : targets_ )
+    {
+      auto volume = std::make_shared< impl::canary_volume >();
+      volume->options = options_;
+      volume->options.onChange = nullptr;  // only called through the shared callback
+      volume->callback = m_callback;
+      volume->status.volume = t.volume;
+      volume->status.file = t.file;
+      volume->window.reserve( options_.windowSize );
+
+      std::thread( impl::run_canary, volume ).detach();
+      m_volumes.push_back( volume );
+    }
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  latency_canary::~latency_canary()
+  {
+    if( m_callback->caller.load() == std::this_thread::get_id() )
+    {
+      // called from onChange, notify() holds the mutex on this thread
+      m_callback->stopped = true;
+    }
+    else
+    {
+      std::lock_guard< std::mutex > lock( m_callback->mutex );
+      m_callback->stopped = true;
+    }
+
+    for( auto& v : m_volumes )
+    {
+      std::lock_guard< std::mutex > lock( v->mutex );
+      v->stopped = true;
+      v->stop.notify_one();
+    }
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  std::vector< canary_status > latency_canary::status() const
+  {
+    std::vector< canary_status > result;
+    result.reserve( m_volumes.size() );
+
+    for( const auto& v : m_volumes )
+    {
+      std::lock_guard< std::mutex > lock( v->mutex );
+      result.push_back( v->current() );
+    }
+
+    return result;
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  std::vector< canary_status > latency_canary::slow_volumes() const
+  {
+    auto result = status();
+    result.erase( 
+      std::remove_if( result.begin(), result.end(), []( const canary_status& s_ ) { return !s_.slow; } ), 
+      result.end() 
+    );
+    return result;
+  }
+
+} // namespace storage
+} // namespace systeminfo
+} // namespace ll
+
 
 
 namespace ll
@@ -36,6 +1137,56 @@ namespace ll
     case storage::storage_type::network:
       return "Network Drive";
 
+    case storage::storage_type::solid_state:
+      return "SSD";
+
+    default:
+      return "Unknown";
+    };
+  }
+
+
+  std::string to_string( storage::storage_transport t_ )
+  {
+    switch ( t_ )
+    {
+    case storage::storage_transport::ata:
+      return "ATA";
+
+    case storage::storage_transport::scsi:
+      return "SCSI";
+
+    case storage::storage_transport::nvme:
+      return "NVMe";
+
+    case storage::storage_transport::virtio:
+      return "VirtIO";
+
+    case storage::storage_transport::usb:
+      return "USB";
+
+    case storage::storage_transport::mmc:
+      return "MMC";
+
+    default:
+      return "Unknown";
+    };
+  }
+
+
+  std::string to_string( storage::space_level l_ )
+  {
+    switch ( l_ )
+    {
+    case storage::space_level::normal:
+      return "Normal";
+
+    case storage::space_level::low:
+      return "Low";
+
+    case storage::space_level::critical:
+      return "Critical";
+
     default:
       return "Unknown";
     };
@@ -0,0 +1,137 @@
+/*************************************************************************************************************
+
+ Limelight Framework - SystemInfo Utils
+
+
+ Copyright 2016 mvd
+
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in
+ compliance with the License. You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software distributed under the License is
+ distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and limitations under the License.
+
+*************************************************************************************************************/
+
+#pragma once
+
+#include "systeminfo/storage.h"
+#include "systeminfo/disk_benchmark.h"
+
+
+namespace ll
+{
+namespace systeminfo
+{
+namespace storage
+{  
+  
+  namespace impl
+  {
+    //! the volume with the longest mount path that contains path_, nullptr if there is none
+    const storage_info::volume* find_owning_volume( const storage_info& info_, const fs::path& path_ );
+
+    //! a line of the mount table
+    struct mount_entry
+    {
+      std::string path;
+      std::uint64_t device = 0;    // the st_dev of the file system, encoded like stat(2) does
+      std::string type;
+      std::string source;
+      std::string upperDirectory;  // of an overlay, empty otherwise
+    };
+
+    //! in the order of the mount tree, a mount that's listed later hides earlier ones on the same path
+    std::vector< mount_entry > read_mount_table();
+
+    //! refreshes the sizes and capacity states of volumes_ within query_.timeout, an unresponsive network
+    //! volume doesn't block the caller; false for the volumes that can't be queried at all
+    std::vector< bool > update_capacities( 
+      std::vector< storage_info::volume >& volumes_, 
+      const storage_query& query_ 
+    );
+
+    //! latencies_ are in nanoseconds and get sorted
+    latency_distribution summarize_latencies( std::vector< std::uint32_t >& latencies_ );
+
+
+    //! the platform specific part of the io_sampler
+    class io_reader
+    {
+    public:
+      virtual ~io_reader() = default;
+
+      //! fills the accumulated values of the devices ordered by major:minor, reusing the elements of devices_
+      virtual void read( std::vector< device_io >& devices_ ) = 0;
+    };
+
+    std::unique_ptr< io_reader > create_io_reader();
+
+
+    //! the platform specific part of the mount_watcher
+    class mount_reader
+    {
+    public:
+      virtual ~mount_reader() = default;
+
+      //! waits up to timeout_ for a change, returns false if there was none
+      virtual bool wait( std::chrono::milliseconds timeout_ ) = 0;
+
+      //! re-reads the mount table, applies the differences to info_ and appends them to events_
+      virtual void update( storage_info& info_, std::vector< volume_event >& events_ ) = 0;
+
+      virtual int native_handle() const = 0;
+    };
+
+    std::unique_ptr< mount_reader > create_mount_reader( scan_network_storage scan_ );
+
+
+    //! the file a latency_canary reads from
+    class canary_file
+    {
+    public:
+      virtual ~canary_file() = default;
+
+      //! reads one block without the page cache, returns 0 or the errno value
+      virtual int read() = 0;
+    };
+
+    //! creates or extends the file if create_ is set, may block on a network volume; nullptr and the errno
+    //! value in error_ if it can't be opened
+    std::unique_ptr< canary_file > open_canary_file( const fs::path& path_, bool create_, int& error_ );
+
+
+    //! the scratch file of the disk benchmark, it's removed when the object is destroyed
+    class benchmark_file
+    {
+    public:
+      virtual ~benchmark_file() = default;
+
+      virtual bool direct_io() const = 0;
+      virtual bool supports( benchmark_engine engine_ ) const = 0;
+
+      //! writes the complete file once, so the read tests don't hit unallocated ranges
+      virtual void fill( unsigned blockSize_ ) = 0;
+
+      //! issues the requests described by test_ until deadline_, appends the latency of each request in
+      //! nanoseconds; throws internal if a request fails
+      virtual void run( 
+        const benchmark_result& test_, 
+        std::chrono::steady_clock::time_point deadline_, 
+        std::vector< std::uint32_t >& latencies_ 
+      ) = 0;
+    };
+
+    std::unique_ptr< benchmark_file > create_benchmark_file( 
+      const fs::path& directory_, 
+      std::uint64_t size_ 
+    );
+
+  }  // namespace impl
+
+}  // namespace storage
+}  // namespace systeminfo
+}  // namespace ll
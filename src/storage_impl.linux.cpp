@@ -17,6 +17,10 @@
 *************************************************************************************************************/
 
 #include "systeminfo/storage.h"
+#include "systeminfo/exception.h"
+#include "storage_impl.h"
+#include "file_utils.linux.h"
+#include "io_uring.linux.h"
 
 #include <platform_utils/linux/shell_utils.h>
 #include <base/environment.h>
@@ -26,11 +30,35 @@ LL_WARNING_DISABLE_GCC( deprecated-declarations )
 #include <boost/algorithm/string.hpp>
 LL_WARNING_ENABLE_GCC( deprecated-declarations )
 
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <set>
 #include <string>
+#include <thread>
+#include <tuple>
 #include <iostream>
 
+#include <fcntl.h>
+#include <linux/fs.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
 #include <sys/statvfs.h>
+#include <sys/syscall.h>
+#include <sys/sysmacros.h>
 #include <mntent.h>
+#include <unistd.h>
 
 
 
@@ -77,16 +105,1259 @@ namespace storage
       if( !type_ ) 
         return filesystem::unknown;
       
-      std::string type( type_ );
-      if( type == "ext4" )
-        return filesystem::ext4;
+      static const std::map< std::string, filesystem > s_types = {
+        { "ext4", filesystem::ext4 },
+        { "xfs", filesystem::xfs },
+        { "btrfs", filesystem::btrfs },
+        { "tmpfs", filesystem::tmpfs },
+        { "overlay", filesystem::overlay },
+        { "zfs", filesystem::zfs },
+        { "nfs", filesystem::nfs },
+        { "nfs4", filesystem::nfs4 },
+        { "cifs", filesystem::smb },
+        { "smb3", filesystem::smb },
+        { "vfat", filesystem::fat32 },
+        { "ntfs", filesystem::ntfs },
+        { "ntfs3", filesystem::ntfs },
+        { "autofs", filesystem::autofs }
+      };
 
-      return filesystem::unknown;
+      auto type = s_types.find( type_ );
+      return ( type != s_types.end() ) ? type->second : filesystem::unknown;
     }
+
+
+    //! resolves a sysfs link to a block device and returns the directory of the whole disk, i.e. the
+    //! parent directory for a partition
+    std::string get_disk_directory( const std::string& link_ )
+    {
+      char path[ PATH_MAX ];
+      if( !::realpath( link_.c_str(), path ) )
+        return std::string();
+
+      std::string directory( path );
+      struct stat partition;
+      if( stat( ( directory + "/partition" ).c_str(), &partition ) == 0 )
+        directory.resize( directory.rfind( '/' ) );
+
+      return directory;
+    }
+
+
+    //! derived from the device path, e.g. /sys/devices/pci0000:00/0000:00:17.0/ata1/host0/.../block/sda
+    storage_transport get_transport( const std::string& diskDirectory_, unsigned depth_ = 0 )
+    {
+      auto contains = [&diskDirectory_]( const char* part_ ) 
+      { 
+        return diskDirectory_.find( part_ ) != std::string::npos; 
+      };
+
+      if( contains( "/virtual/block/" ) )
+      {
+        // dm and md devices take the transport of their first underlying device
+        auto slaves = diskDirectory_ + "/slaves";
+        for( const auto& slave : detail::list_directory( slaves ) )
+        {
+          auto directory = get_disk_directory( slaves + "/" + slave );
+          if( !directory.empty() && ( depth_ < 8 ) )
+            return get_transport( directory, depth_ + 1 );
+        }
+
+        return storage_transport::unknown;
+      }
+
+      // usb and ata disks are attached to a scsi host as well
+      if( contains( "/usb" ) )
+        return storage_transport::usb;
+      if( contains( "/nvme" ) )
+        return storage_transport::nvme;
+      if( contains( "/mmc_host/" ) )
+        return storage_transport::mmc;
+      if( contains( "/ata" ) )
+        return storage_transport::ata;
+      if( contains( "/host" ) )
+        return storage_transport::scsi;  // including virtio-scsi
+      if( contains( "/virtio" ) )
+        return storage_transport::virtio;
+
+      return storage_transport::unknown;
+    }
+
+
+    bool read_block_device( unsigned major_, unsigned minor_, storage_info::block_device& device_ )
+    {
+      auto directory = get_disk_directory( 
+        "/sys/dev/block/" + std::to_string( major_ ) + ":" + std::to_string( minor_ ) 
+      );
+      if( directory.empty() )
+        return false;
+
+      auto queue = directory + "/queue/";
+      auto read_queue = [&queue]( const char* attribute_ ) 
+      { 
+        return static_cast< unsigned >( detail::read_uint( queue + attribute_ ) ); 
+      };
+
+      device_.name = directory.substr( directory.rfind( '/' ) + 1 );
+      device_.transport = get_transport( directory );
+      device_.rotational = read_queue( "rotational" ) != 0;
+      device_.removable = detail::read_uint( directory + "/removable" ) != 0;
+
+      device_.logicalBlockSize = read_queue( "logical_block_size" );
+      device_.physicalBlockSize = read_queue( "physical_block_size" );
+      device_.minimumIoSize = read_queue( "minimum_io_size" );
+      device_.optimalIoSize = read_queue( "optimal_io_size" );
+
+      device_.queueDepth = read_queue( "nr_requests" );
+      device_.readAheadInKilobytes = read_queue( "read_ahead_kb" );
+
+      // e.g. "none [mq-deadline] kyber bfq", the active one is in brackets
+      device_.scheduler = detail::read_line( queue + "scheduler" );
+      auto first = device_.scheduler.find( '[' );
+      auto last = device_.scheduler.find( ']' );
+      if( ( first != std::string::npos ) && ( last != std::string::npos ) && ( first < last ) )
+        device_.scheduler = device_.scheduler.substr( first + 1, last - first - 1 );
+
+      return true;
+    }
+
+
+    storage_type block_device_to_volume_type( const storage_info::block_device& device_ )
+    {
+      if( device_.removable || ( device_.transport == storage_transport::usb ) )
+        return storage_type::removable;
+
+      return device_.rotational ? storage_type::harddisk : storage_type::solid_state;
+    }
+
+
+    bool is_network_filesystem( const std::string& type_ )
+    {
+      static const char* s_types[] = { "nfs", "nfs4", "cifs", "smb3", "smbfs", "ceph", "afs", "9p" };
+      return std::any_of( std::begin( s_types ), std::end( s_types ), [&type_]( const char* t_ ) 
+      { 
+        return type_ == t_; 
+      } );
+    }
+
+
+    //! block devices and, depending on scan_, network file systems
+    bool is_volume( const std::string& fsname_, const std::string& type_, scan_network_storage scan_ )
+    {
+      if( is_network_filesystem( type_ ) )
+        return scan_ == scan_network_storage::include;
+
+      return fsname_.compare( 0, 5, "/dev/" ) == 0;
+    }
+
+
+    //! everything but the sizes, see query_capacities
+    void create_volume( 
+      const char* dir_, 
+      const char* fsname_, 
+      const char* type_, 
+      storage_info::volume& volume_ 
+    )
+    {
+      volume_.path = dir_;
+      volume_.name = mnt_dir_to_volume_name( dir_ );
+      volume_.fileSystem = mnt_type_to_filesystem( type_ );
+
+      if( is_network_filesystem( type_ ) )
+      {
+        volume_.type = storage_type::network;
+        return;
+      }
+
+      // the device node rather than st_dev of the mount point, which is a virtual device e.g. for btrfs
+      struct stat64 device;
+      if( ( stat64( fsname_, &device ) == 0 ) && S_ISBLK( device.st_mode ) )
+      {
+        volume_.deviceMajor = major( device.st_rdev );
+        volume_.deviceMinor = minor( device.st_rdev );
+      }
+
+      if( read_block_device( volume_.deviceMajor, volume_.deviceMinor, volume_.device ) )
+        volume_.type = block_device_to_volume_type( volume_.device );
+      else
+        volume_.type = fsname_to_volume_type( fsname_ );
+    }
+
+
+    //! the results of the statvfs queries of one call of query_capacities, shared with the workers
+    struct capacity_batch
+    {
+      std::mutex mutex;
+      std::condition_variable finished;
+      std::vector< std::string > paths;
+      std::vector< int > results;  // -1 while queued or not queried, otherwise 0 (answered) or 1 (failed)
+      size_t remaining = 0;
+    };
+
+
+    struct capacity_job
+    {
+      std::shared_ptr< capacity_batch > batch;
+      size_t index;
+    };
+
+
+    //! the sizes of the file systems that have been queried and the pool of workers that query them
+    struct capacity_registry
+    {
+      struct capacity
+      {
+        std::uint64_t totalSizeInBytes = 0;
+        std::uint64_t availableSizeInBytes = 0;
+      };
+
+      std::mutex mutex;
+      std::condition_variable queued;
+      std::deque< capacity_job > jobs;
+      size_t idleWorkers = 0;
+      size_t startingWorkers = 0;  // started but not waiting for jobs yet
+
+      std::map< std::string, capacity > lastKnown;
+
+      //! the start of the statvfs calls that haven't returned yet, possibly hung
+      std::map< std::string, std::chrono::steady_clock::time_point > pending;
+    };
+
+
+    //! a query that takes longer probably hangs, its worker no longer counts towards the pool size
+    const std::chrono::milliseconds s_slowCapacityQuery{ 100 };
+
+    //! idle workers end after this time, the pool only exists while capacities are queried
+    const std::chrono::seconds s_capacityWorkerIdleTime{ 30 };
+
+
+    capacity_registry& get_capacity_registry()
+    {
+      // never destroyed, a hung worker may still access it when the process exits
+      static capacity_registry* s_registry = new capacity_registry();
+      return *s_registry;
+    }
+
+
+    void run_capacity_worker()
+    {
+      auto& registry = get_capacity_registry();
+
+      std::unique_lock< std::mutex > lock( registry.mutex );
+      --registry.startingWorkers;
+      for( ;; )
+      {
+        ++registry.idleWorkers;
+        bool available = registry.queued.wait_for( 
+          lock, 
+          s_capacityWorkerIdleTime, 
+          [&registry]() { return !registry.jobs.empty(); } 
+        );
+        --registry.idleWorkers;
+        if( !available )
+          return;
+
+        auto job = registry.jobs.front();
+        registry.jobs.pop_front();
+
+        // no second query of a file system whose previous one hasn't returned
+        int result = -1;
+        const auto& path = job.batch->paths[ job.index ];
+        if( registry.pending.find( path ) == registry.pending.end() )
+        {
+          registry.pending[ path ] = std::chrono::steady_clock::now();
+          lock.unlock();
+
+          struct statvfs64 fs;
+          bool answered = statvfs64( path.c_str(), &fs ) == 0;
+
+          lock.lock();
+          registry.pending.erase( path );
+          if( answered )
+          {
+            auto& capacity = registry.lastKnown[ path ];
+            capacity.totalSizeInBytes = fs.f_blocks * fs.f_frsize;
+            capacity.availableSizeInBytes = fs.f_bavail * fs.f_frsize;
+          }
+          result = answered ? 0 : 1;
+        }
+
+        {
+          std::lock_guard< std::mutex > batchLock( job.batch->mutex );
+          job.batch->results[ job.index ] = result;
+          --job.batch->remaining;
+        }
+        job.batch->finished.notify_all();
+      }
+    }
+
+
+    //! starts workers until there are enough for the queued jobs; workers that are stuck in a query for
+    //! longer than s_slowCapacityQuery don't count, so a hung file system doesn't delay the healthy ones
+    void start_capacity_workers( capacity_registry& registry_, unsigned parallelQueries_ )
+    {
+      auto now = std::chrono::steady_clock::now();
+      auto available = registry_.idleWorkers + registry_.startingWorkers;
+      auto responsive = available;
+      for( const auto& p : registry_.pending )
+      {
+        if( now - p.second < s_slowCapacityQuery )
+          ++responsive;
+      }
+
+      auto limit = static_cast< size_t >( std::max( parallelQueries_, 1u ) );
+      auto needed = std::min( limit, registry_.jobs.size() );
+      for( ; ( available < needed ) && ( responsive < limit ); ++available, ++responsive )
+      {
+        ++registry_.startingWorkers;
+        std::thread( run_capacity_worker ).detach();
+      }
+    }
+
+
+    //! fills the sizes with statvfs, which blocks indefinitely on an unresponsive network file system; the
+    //! queries run on a small pool of workers, so an unresponsive one costs a worker rather than blocking the
+    //! caller, and no second query is started for a file system that hasn't answered yet
+    //! returns false for the volumes that can't be queried at all, e.g. due to missing permissions
+    std::vector< bool > query_capacities( 
+      std::vector< storage_info::volume >& volumes_, 
+      const storage_query& query_ 
+    )
+    {
+      auto& registry = get_capacity_registry();
+      auto b = std::make_shared< capacity_batch >();
+
+      // the query of each volume in b->paths, stacked mounts share one
+      std::map< std::string, size_t > queries;
+      std::vector< size_t > queryIndices( volumes_.size() );
+      for( size_t i = 0; i < volumes_.size(); ++i )
+      {
+        auto path = volumes_[ i ].path.string();
+        auto query = queries.insert( std::make_pair( path, b->paths.size() ) );
+        if( query.second )
+          b->paths.push_back( path );
+        queryIndices[ i ] = query.first->second;
+      }
+
+      b->results.assign( b->paths.size(), -1 );
+      b->remaining = b->paths.size();
+
+      auto deadline = std::chrono::steady_clock::now() + query_.timeout;
+      {
+        std::lock_guard< std::mutex > lock( registry.mutex );
+        for( size_t i = 0; i < b->paths.size(); ++i )
+          registry.jobs.push_back( capacity_job{ b, i } );
+
+        start_capacity_workers( registry, query_.parallelQueries );
+      }
+      registry.queued.notify_all();
+
+      std::vector< int > results;
+      for( ;; )
+      {
+        {
+          std::unique_lock< std::mutex > lock( b->mutex );
+          auto now = std::chrono::steady_clock::now();
+          b->finished.wait_until( 
+            lock, 
+            std::min( deadline, now + s_slowCapacityQuery ), 
+            [&b]() { return b->remaining == 0; } 
+          );
+
+          if( ( b->remaining == 0 ) || ( std::chrono::steady_clock::now() >= deadline ) )
+          {
+            results = b->results;
+            break;
+          }
+        }
+
+        // some workers are stuck, the registry is never locked while holding the lock of a batch
+        std::lock_guard< std::mutex > lock( registry.mutex );
+        start_capacity_workers( registry, query_.parallelQueries );
+      }
+
+      std::vector< bool > usable( volumes_.size(), true );
+
+      std::lock_guard< std::mutex > lock( registry.mutex );
+
+      // the jobs that are still queued are of no use to anybody after the deadline
+      registry.jobs.erase( 
+        std::remove_if( 
+          registry.jobs.begin(), 
+          registry.jobs.end(), 
+          [&b]( const capacity_job& job_ ) { return job_.batch == b; } 
+        ), 
+        registry.jobs.end() 
+      );
+
+      for( size_t i = 0; i < volumes_.size(); ++i )
+      {
+        auto& v = volumes_[ i ];
+        auto result = results[ queryIndices[ i ] ];
+        if( result == 1 )
+        {
+          usable[ i ] = false;
+          continue;
+        }
+
+        auto capacity = registry.lastKnown.find( v.path.string() );
+        if( capacity == registry.lastKnown.end() )
+        {
+          v.capacity = capacity_state::timed_out;
+          continue;
+        }
+
+        v.totalSizeInBytes = capacity->second.totalSizeInBytes;
+        v.availableSizeInBytes = capacity->second.availableSizeInBytes;
+        v.capacity = ( result == 0 ) ? capacity_state::current : capacity_state::stale;
+      }
+
+      return usable;
+    }
+
+
+    //! drops the sizes of the file systems that are no longer mounted, on a container host there would be
+    //! an entry for every container that ever ran
+    void prune_capacities( const std::set< std::string >& mounted_ )
+    {
+      auto& registry = get_capacity_registry();
+      std::lock_guard< std::mutex > lock( registry.mutex );
+      for( auto it = registry.lastKnown.begin(); it != registry.lastKnown.end(); )
+      {
+        if( mounted_.count( it->first ) == 0 )
+          it = registry.lastKnown.erase( it );
+        else
+          ++it;
+      }
+    }
+
+
+    void prune_capacities( const std::vector< impl::mount_entry >& mounts_ )
+    {
+      std::set< std::string > mounted;
+      for( const auto& m : mounts_ )
+        mounted.insert( m.path );
+      prune_capacities( mounted );
+    }
+
+
+    //! reads /proc/diskstats, see https://www.kernel.org/doc/Documentation/ABI/testing/procfs-diskstats
+    class diskstats_reader : public impl::io_reader
+    {
+    public:
+      diskstats_reader() 
+        : m_file( "/proc/diskstats" )
+      {
+      }
+
+      void read( std::vector< device_io >& devices_ ) override
+      {
+        if( !m_file.read() )
+        {
+          devices_.clear();
+          return;
+        }
+
+        size_t count = 0;
+        const char* p = m_file.data();
+        const char* end = m_file.end();
+        while( p != end )
+        {
+          if( count == devices_.size() )
+            devices_.emplace_back();
+
+          if( parse_line( p, end, devices_[ count ] ) )
+            ++count;
+
+          detail::skip_line( p, end );
+        }
+
+        devices_.resize( count );
+
+        // the kernel lists the devices in the order they were registered
+        auto less = []( const device_io& lhs_, const device_io& rhs_ ) 
+        { 
+          return std::tie( lhs_.major, lhs_.minor ) < std::tie( rhs_.major, rhs_.minor ); 
+        };
+        if( !std::is_sorted( devices_.begin(), devices_.end(), less ) )
+          std::sort( devices_.begin(), devices_.end(), less );
+      }
+
+    private:
+      static bool parse_line( const char* p_, const char* end_, device_io& device_ )
+      {
+        const std::uint64_t sectorSize = 512;  // the unit of diskstats, independent of the device
+
+        auto skip_blanks = [&p_, end_]()
+        {
+          while( ( p_ != end_ ) && ( *p_ == ' ' ) )
+            ++p_;
+        };
+
+        device_.major = static_cast< unsigned >( detail::parse_uint( p_, end_ ) );
+        device_.minor = static_cast< unsigned >( detail::parse_uint( p_, end_ ) );
+
+        skip_blanks();
+        const char* name = p_;
+        while( ( p_ != end_ ) && ( *p_ != ' ' ) && ( *p_ != '\n' ) )
+          ++p_;
+        if( p_ == name )
+          return false;
+        device_.name.assign( name, p_ );
+
+        std::uint64_t fields[ 11 ] = { 0 };
+        for( auto& f : fields )
+          f = detail::parse_uint( p_, end_ );
+
+        device_.reads = fields[ 0 ];
+        device_.readBytes = fields[ 2 ] * sectorSize;
+        device_.readTime = std::chrono::milliseconds( fields[ 3 ] );
+        device_.writes = fields[ 4 ];
+        device_.writeBytes = fields[ 6 ] * sectorSize;
+        device_.writeTime = std::chrono::milliseconds( fields[ 7 ] );
+        device_.requestsInFlight = static_cast< unsigned >( fields[ 8 ] );
+        device_.ioTime = std::chrono::milliseconds( fields[ 9 ] );
+        device_.weightedIoTime = std::chrono::milliseconds( fields[ 10 ] );
+        return true;
+      }
+
+      detail::proc_file m_file;
+    };
+
+
+    //! mount points are escaped in octal, e.g. a space as \040
+    std::string unescape_mount_point( const char* begin_, const char* end_ )
+    {
+      std::string result;
+      result.reserve( static_cast< size_t >( end_ - begin_ ) );
+
+      auto isOctal = []( char c_ ) { return ( c_ >= '0' ) && ( c_ <= '7' ); };
+      for( auto p = begin_; p != end_; ++p )
+      {
+        bool escaped = ( *p == '\\' ) && ( end_ - p >= 4 );
+        if( escaped && isOctal( p[ 1 ] ) && isOctal( p[ 2 ] ) && isOctal( p[ 3 ] ) )
+        {
+          result += static_cast< char >( ( p[ 1 ] - '0' ) * 64 + ( p[ 2 ] - '0' ) * 8 + ( p[ 3 ] - '0' ) );
+          p += 3;
+        }
+        else
+          result += *p;
+      }
+
+      return result;
+    }
+
+
+    volume_event to_event( volume_change change_, const storage_info::volume& volume_ )
+    {
+      volume_event event;
+      event.change = change_;
+      event.volume = volume_;
+      return event;
+    }
+
+
+    //! watches /proc/self/mountinfo, see https://www.kernel.org/doc/Documentation/filesystems/proc.txt
+    class mountinfo_reader : public impl::mount_reader
+    {
+    public:
+      explicit mountinfo_reader( scan_network_storage scan_ )
+        : m_file( "/proc/self/mountinfo" )
+      {
+        m_query.scan = scan_;
+        if( !m_file.is_open() )
+          throw exception( error::invalid_request, "mountinfo" );
+      }
+
+      bool wait( std::chrono::milliseconds timeout_ ) override
+      {
+        // the kernel signals POLLPRI | POLLERR once per change of the mount table
+        pollfd fd = { m_file.fd(), POLLPRI, 0 };
+        int result = 0;
+        do
+        {
+          result = ::poll( &fd, 1, static_cast< int >( timeout_.count() ) );
+        } while( ( result < 0 ) && ( errno == EINTR ) );
+
+        return ( result > 0 ) && ( ( fd.revents & ( POLLPRI | POLLERR ) ) != 0 );
+      }
+
+      void update( storage_info& info_, std::vector< volume_event >& events_ ) override
+      {
+        std::swap( m_mounts, m_previousMounts );
+        read_mounts();
+
+        struct candidate
+        {
+          size_t mount;    // the index in m_mounts
+          bool wasVolume;  // the mount id belonged to a volume before
+        };
+
+        std::vector< std::uint64_t > removed;
+        std::vector< candidate > candidates;
+        std::vector< storage_info::volume > volumes;  // one per candidate
+
+        // both lists are ordered by mount id, unchanged lines are neither parsed nor queried again
+        auto previous = m_previousMounts.begin();
+        for( size_t i = 0; i < m_mounts.size(); ++i )
+        {
+          auto& m = m_mounts[ i ];
+          for( ; ( previous != m_previousMounts.end() ) && ( previous->id < m.id ); ++previous )
+          {
+            if( previous->volume )
+              removed.push_back( previous->id );
+          }
+
+          bool existed = ( previous != m_previousMounts.end() ) && ( previous->id == m.id );
+          if( existed && ( previous->line == m.line ) )
+          {
+            m.volume = previous->volume;
+            ++previous;
+            continue;
+          }
+
+          bool wasVolume = existed && previous->volume;
+          if( existed )
+            ++previous;
+
+          m.volume = false;
+          volumes.emplace_back();
+          if( mount_to_volume( m.line, volumes.back() ) )
+            candidates.push_back( candidate{ i, wasVolume } );
+          else
+          {
+            volumes.pop_back();
+            if( wasVolume )
+              removed.push_back( m.id );
+          }
+        }
+
+        for( ; previous != m_previousMounts.end(); ++previous )
+        {
+          if( previous->volume )
+            removed.push_back( previous->id );
+        }
+
+        for( auto id : removed )
+          remove_volume( id, info_, events_ );
+
+        if( !removed.empty() )
+        {
+          std::set< std::string > mounted;
+          for( const auto& m : m_mounts )
+            mounted.insert( mount_point( m.line ) );
+          prune_capacities( mounted );
+        }
+
+        // the new and changed volumes are queried in one go
+        auto usable = query_capacities( volumes, m_query );
+        for( size_t c = 0; c < candidates.size(); ++c )
+        {
+          auto& m = m_mounts[ candidates[ c ].mount ];
+          auto& volume = volumes[ c ];
+
+          auto index = candidates[ c ].wasVolume ? find_volume( m.id ) : m_volumeIds.size();
+          bool samePath = ( index < m_volumeIds.size() ) && ( info_.volumes[ index ].path == volume.path );
+          if( usable[ c ] && samePath )
+          {
+            m.volume = true;
+            info_.volumes[ index ] = volume;
+            events_.push_back( to_event( volume_change::changed, volume ) );
+            continue;
+          }
+
+          // a mount id that got reused for a different mount point
+          if( candidates[ c ].wasVolume )
+            remove_volume( m.id, info_, events_ );
+
+          if( usable[ c ] )
+          {
+            m.volume = true;
+            info_.volumes.push_back( volume );
+            m_volumeIds.push_back( m.id );
+            events_.push_back( to_event( volume_change::added, volume ) );
+          }
+        }
+      }
+
+      int native_handle() const override
+      {
+        return m_file.fd();
+      }
+
+    private:
+      struct mount
+      {
+        std::uint64_t id = 0;
+        std::string line;
+        bool volume = false;
+      };
+
+      void read_mounts()
+      {
+        if( !m_file.read() )
+        {
+          m_mounts.clear();
+          return;
+        }
+
+        size_t count = 0;
+        const char* p = m_file.data();
+        const char* end = m_file.end();
+        while( p != end )
+        {
+          const char* line = p;
+          detail::skip_line( p, end );
+
+          if( count == m_mounts.size() )
+            m_mounts.emplace_back();
+
+          auto& m = m_mounts[ count++ ];
+          const char* id = line;
+          m.id = detail::parse_uint( id, p );
+          m.line.assign( line, ( ( p != line ) && ( p[ -1 ] == '\n' ) ) ? p - 1 : p );
+        }
+
+        m_mounts.resize( count );
+
+        // the ids are usually ascending, but the kernel lists the mounts in the order of the tree
+        auto less = []( const mount& lhs_, const mount& rhs_ ) { return lhs_.id < rhs_.id; };
+        if( !std::is_sorted( m_mounts.begin(), m_mounts.end(), less ) )
+          std::sort( m_mounts.begin(), m_mounts.end(), less );
+      }
+
+      //! the fifth field, e.g. /mnt2 of the line below
+      static std::string mount_point( const std::string& line_ )
+      {
+        const char* p = line_.data();
+        const char* end = p + line_.size();
+        const char* begin = p;
+        for( unsigned field = 1; field <= 5; ++field )
+        {
+          while( ( p != end ) && ( *p == ' ' ) )
+            ++p;
+          begin = p;
+          while( ( p != end ) && ( *p != ' ' ) )
+            ++p;
+        }
+        return unescape_mount_point( begin, p );
+      }
+
+      //! e.g. "36 35 98:0 /mnt1 /mnt2 rw,noatime master:1 - ext3 /dev/root rw,errors=continue"
+      bool mount_to_volume( const std::string& line_, storage_info::volume& volume_ ) const
+      {
+        const char* p = line_.data();
+        const char* end = p + line_.size();
+        auto next_field = [&p, end]( const char*& begin_ )
+        {
+          while( ( p != end ) && ( *p == ' ' ) )
+            ++p;
+          begin_ = p;
+          while( ( p != end ) && ( *p != ' ' ) )
+            ++p;
+          return p;
+        };
+
+        const char* begin = nullptr;
+        for( unsigned field = 1; field <= 4; ++field )
+          next_field( begin );
+
+        auto mountPointEnd = next_field( begin );
+        auto mountPoint = unescape_mount_point( begin, mountPointEnd );
+
+        // the optional fields are terminated by a single hyphen
+        do
+        {
+          next_field( begin );
+        } while( ( begin != end ) && !( ( p - begin == 1 ) && ( *begin == '-' ) ) );
+
+        auto typeEnd = next_field( begin );
+        std::string type( begin, typeEnd );
+        auto sourceEnd = next_field( begin );
+        std::string source( begin, sourceEnd );
+
+        if( !is_volume( source, type, m_query.scan ) )
+          return false;
+
+        create_volume( mountPoint.c_str(), source.c_str(), type.c_str(), volume_ );
+        return true;
+      }
+
+      size_t find_volume( std::uint64_t id_ ) const
+      {
+        auto it = std::find( m_volumeIds.begin(), m_volumeIds.end(), id_ );
+        return static_cast< size_t >( it - m_volumeIds.begin() );
+      }
+
+      void remove_volume( std::uint64_t id_, storage_info& info_, std::vector< volume_event >& events_ )
+      {
+        auto index = find_volume( id_ );
+        if( index >= m_volumeIds.size() )
+          return;
+
+        events_.push_back( to_event( volume_change::removed, info_.volumes[ index ] ) );
+        info_.volumes.erase( info_.volumes.begin() + static_cast< std::ptrdiff_t >( index ) );
+        m_volumeIds.erase( m_volumeIds.begin() + static_cast< std::ptrdiff_t >( index ) );
+      }
+
+      storage_query m_query;
+      detail::proc_file m_file;
+      std::vector< mount > m_mounts;          // ordered by id
+      std::vector< mount > m_previousMounts;
+      std::vector< std::uint64_t > m_volumeIds;  // the mount ids of info_.volumes, in the same order
+    };
+
+
+    //! a file in the probed directory, it's removed again when the probe is done
+    class scratch_file
+    {
+    public:
+      explicit scratch_file( const std::string& directory_ )
+        : m_path( directory_ + "/.ll_systeminfo_probe_XXXXXX" )
+      {
+        m_fd = ::mkostemp( &m_path[ 0 ], O_CLOEXEC );
+      }
+
+      ~scratch_file()
+      {
+        if( m_fd < 0 )
+          return;
+
+        ::close( m_fd );
+        ::unlink( m_path.c_str() );
+      }
+
+      scratch_file( const scratch_file& ) = delete;
+      scratch_file& operator=( const scratch_file& ) = delete;
+
+      int fd() const { return m_fd; }
+      const std::string& path() const { return m_path; }
+
+    private:
+      std::string m_path;
+      int m_fd = -1;
+    };
+
+
+    void probe_direct_io( const scratch_file& file_, io_capabilities& capabilities_ )
+    {
+      // e.g. EINVAL on tmpfs before linux 6.6
+      int fd = ::open( file_.path().c_str(), O_RDWR | O_DIRECT | O_CLOEXEC );
+      if( fd < 0 )
+        return;
+
+      capabilities_.directIo = true;
+
+#if defined( STATX_DIOALIGN )
+      // linux 6.1 and later report the alignments themselves
+      struct statx attributes;
+      if( ( ::statx( fd, "", AT_EMPTY_PATH, STATX_DIOALIGN, &attributes ) == 0 ) &&
+          ( attributes.stx_mask & STATX_DIOALIGN ) && ( attributes.stx_dio_offset_align != 0 ) )
+      {
+        capabilities_.directIoMemoryAlignment = attributes.stx_dio_mem_align;
+        capabilities_.directIoOffsetAlignment = attributes.stx_dio_offset_align;
+      }
+#endif
+
+      if( capabilities_.directIoOffsetAlignment == 0 )
+      {
+        // the smallest write that succeeds, the buffer alignment can't be smaller than that
+        const size_t maxAlignment = 4096;
+        void* buffer = nullptr;
+        if( ::posix_memalign( &buffer, maxAlignment, maxAlignment ) == 0 )
+        {
+          std::memset( buffer, 0, maxAlignment );
+          for( size_t size = 512; size <= maxAlignment; size *= 2 )
+          {
+            if( ::pwrite( fd, buffer, size, 0 ) == static_cast< ssize_t >( size ) )
+            {
+              capabilities_.directIoMemoryAlignment = static_cast< unsigned >( size );
+              capabilities_.directIoOffsetAlignment = static_cast< unsigned >( size );
+              break;
+            }
+          }
+
+          ::free( buffer );
+        }
+      }
+
+      ::close( fd );
+    }
+
+
+    void probe_allocation( const scratch_file& file_, io_capabilities& capabilities_ )
+    {
+      const off_t size = 1024 * 1024;
+      capabilities_.fallocate = ::fallocate( file_.fd(), 0, 0, size ) == 0;
+      if( capabilities_.fallocate )
+      {
+        capabilities_.punchHole =
+          ::fallocate( file_.fd(), FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, 0, size / 2 ) == 0;
+      }
+    }
+
+
+    void probe_copies( const scratch_file& file_, io_capabilities& capabilities_ )
+    {
+      std::vector< char > data( 4096, 'x' );
+      if( ::pwrite( file_.fd(), data.data(), data.size(), 0 ) != static_cast< ssize_t >( data.size() ) )
+        return;
+
+      scratch_file target( file_.path().substr( 0, file_.path().rfind( '/' ) ) );
+      if( target.fd() < 0 )
+        return;
+
+#if defined( FICLONE )
+      capabilities_.reflink = ::ioctl( target.fd(), FICLONE, file_.fd() ) == 0;
+#endif
+
+#if defined( SYS_copy_file_range )
+      // may fall back to a regular copy within the kernel, e.g. on ext4
+      loff_t from = 0, to = 0;
+      auto copied = ::syscall( SYS_copy_file_range, file_.fd(), &from, target.fd(), &to, data.size(), 0u );
+      capabilities_.copyFileRange = copied > 0;
+#endif
+    }
+
+
+#if defined( LL_SYSTEMINFO_IO_URING )
+    //! submits a single IORING_OP_OPENAT (linux 5.6)
+    bool probe_io_uring( const std::string& path_ )
+    {
+      detail::io_ring ring( 1 );
+      auto sqe = ring.get_sqe();
+      if( !sqe )
+        return false;  // e.g. disabled by kernel.io_uring_disabled or a seccomp filter
+
+      sqe->opcode = IORING_OP_OPENAT;
+      sqe->fd = AT_FDCWD;
+      sqe->addr = reinterpret_cast< std::uint64_t >( path_.c_str() );
+      sqe->open_flags = O_RDONLY | O_CLOEXEC;
+
+      auto cqe = ( ring.submit( 1 ) == 1 ) ? ring.peek() : nullptr;
+      if( !cqe )
+        return false;
+
+      // the result is the file descriptor, -EINVAL if the kernel doesn't know the operation
+      if( cqe->res < 0 )
+        return false;
+
+      ::close( cqe->res );
+      return true;
+    }
+#endif
+
+
+    const size_t s_benchmarkAlignment = 4096;  // covers the logical block size of all common devices
+
+    using aligned_buffer = std::unique_ptr< char, decltype( &std::free ) >;
+
+    aligned_buffer allocate_aligned( size_t size_ )
+    {
+      void* p = nullptr;
+      if( ::posix_memalign( &p, s_benchmarkAlignment, size_ ) != 0 )
+        throw exception( error::internal, ENOMEM );
+
+      // not zeros, some devices compress or skip them
+      std::memset( p, 0x5a, size_ );
+      return aligned_buffer( static_cast< char* >( p ), &std::free );
+    }
+
+
+    //! the offsets of the requests of a single test, shared by all threads / requests in flight
+    class benchmark_offsets
+    {
+    public:
+      benchmark_offsets( const benchmark_result& test_, std::uint64_t fileSize_ )
+        : m_random( test_.pattern == benchmark_pattern::random_read ), 
+          m_blockSize( test_.blockSize ), 
+          m_blocks( fileSize_ / test_.blockSize )
+      {
+      }
+
+      //! generator_ is only used for random offsets, each thread has its own
+      std::uint64_t next( std::minstd_rand& generator_ )
+      {
+        if( m_random )
+        {
+          std::uniform_int_distribution< std::uint64_t > block( 0, m_blocks - 1 );
+          return block( generator_ ) * m_blockSize;
+        }
+
+        return ( m_next.fetch_add( 1, std::memory_order_relaxed ) % m_blocks ) * m_blockSize;
+      }
+
+    private:
+      bool m_random;
+      std::uint64_t m_blockSize;
+      std::uint64_t m_blocks;
+      std::atomic< std::uint64_t > m_next{ 0 };
+    };
+
+
+    std::uint32_t elapsed_nanoseconds( 
+      std::chrono::steady_clock::time_point start_, 
+      std::chrono::steady_clock::time_point stop_ 
+    )
+    {
+      auto ns = std::chrono::duration_cast< std::chrono::nanoseconds >( stop_ - start_ ).count();
+      return static_cast< std::uint32_t >( std::min< std::int64_t >( ns, UINT32_MAX ) );
+    }
+
+
+    class scratch_benchmark_file : public impl::benchmark_file
+    {
+    public:
+      scratch_benchmark_file( const std::string& directory_, std::uint64_t size_ )
+        : m_scratch( directory_ ), m_size( size_ )
+      {
+        if( m_scratch.fd() < 0 )
+          throw exception( error::invalid_parameter, directory_ );
+
+        // the scratch file keeps its buffered descriptor for the clean up
+        m_directFd = ::open( m_scratch.path().c_str(), O_RDWR | O_DIRECT | O_CLOEXEC );
+
+        // reserves the space up front, so a full volume is detected before the tests
+        auto size = static_cast< off_t >( m_size );
+        if( ( ::fallocate( m_scratch.fd(), 0, 0, size ) != 0 ) && ( errno == ENOSPC ) )
+          throw exception( error::invalid_parameter, ENOSPC );
+      }
+
+      ~scratch_benchmark_file()
+      {
+        if( m_directFd >= 0 )
+          ::close( m_directFd );
+      }
+
+      bool direct_io() const override
+      {
+        return m_directFd >= 0;
+      }
+
+      bool supports( benchmark_engine engine_ ) const override
+      {
+#if defined( LL_SYSTEMINFO_IO_URING )
+        if( engine_ == benchmark_engine::io_uring )
+          return detail::io_ring( 1 ).is_open();
+#else
+        if( engine_ == benchmark_engine::io_uring )
+          return false;
+#endif
+        return true;
+      }
+
+      void fill( unsigned blockSize_ ) override
+      {
+        auto buffer = allocate_aligned( blockSize_ );
+        for( std::uint64_t offset = 0; offset < m_size; offset += blockSize_ )
+        {
+          auto size = static_cast< size_t >( std::min< std::uint64_t >( blockSize_, m_size - offset ) );
+          auto count = ::pwrite( fd(), buffer.get(), size, static_cast< off_t >( offset ) );
+          if( count != static_cast< ssize_t >( size ) )
+            throw exception( error::internal, ( count < 0 ) ? errno : EIO );
+        }
+
+        ::fdatasync( fd() );
+      }
+
+      void run( 
+        const benchmark_result& test_, 
+        std::chrono::steady_clock::time_point deadline_, 
+        std::vector< std::uint32_t >& latencies_ 
+      ) override
+      {
+        if( test_.engine == benchmark_engine::io_uring )
+          run_io_uring( test_, deadline_, latencies_ );
+        else
+          run_sync( test_, deadline_, latencies_ );
+      }
+
+    private:
+      int fd() const
+      {
+        return ( m_directFd >= 0 ) ? m_directFd : m_scratch.fd();
+      }
+
+      //! one thread per request in flight, the calling thread is one of them
+      void run_sync( 
+        const benchmark_result& test_, 
+        std::chrono::steady_clock::time_point deadline_, 
+        std::vector< std::uint32_t >& latencies_ 
+      )
+      {
+        benchmark_offsets offsets( test_, m_size );
+        bool write = test_.pattern == benchmark_pattern::sequential_write;
+
+        // allocated up front, the threads must not throw
+        std::vector< aligned_buffer > buffers;
+        std::vector< std::vector< std::uint32_t > > threadLatencies( test_.queueDepth );
+        for( unsigned i = 0; i < test_.queueDepth; ++i )
+          buffers.push_back( allocate_aligned( test_.blockSize ) );
+
+        std::atomic< int > failure{ 0 };
+        auto worker = [&]( unsigned index_ )
+        {
+          std::minstd_rand generator( index_ + 1 );
+          auto buffer = buffers[ index_ ].get();
+          auto& latencies = ( index_ == 0 ) ? latencies_ : threadLatencies[ index_ ];
+
+          for( ;; )
+          {
+            auto start = std::chrono::steady_clock::now();
+            if( ( start >= deadline_ ) || failure.load( std::memory_order_relaxed ) )
+              break;
+
+            auto offset = static_cast< off_t >( offsets.next( generator ) );
+            auto count = write ? ::pwrite( fd(), buffer, test_.blockSize, offset ) 
+                               : ::pread( fd(), buffer, test_.blockSize, offset );
+            if( count != static_cast< ssize_t >( test_.blockSize ) )
+            {
+              failure = ( count < 0 ) ? errno : EIO;
+              break;
+            }
+
+            latencies.push_back( elapsed_nanoseconds( start, std::chrono::steady_clock::now() ) );
+          }
+        };
+
+        std::vector< std::thread > threads;
+        for( unsigned i = 1; i < test_.queueDepth; ++i )
+          threads.emplace_back( worker, i );
+        worker( 0 );
+
+        for( auto& t : threads )
+          t.join();
+
+        if( failure )
+          throw exception( error::internal, failure.load() );
+
+        for( const auto& l : threadLatencies )
+          latencies_.insert( latencies_.end(), l.begin(), l.end() );
+      }
+
+      //! keeps queueDepth requests in flight from the calling thread
+      void run_io_uring( 
+        const benchmark_result& test_, 
+        std::chrono::steady_clock::time_point deadline_, 
+        std::vector< std::uint32_t >& latencies_ 
+      )
+      {
+#if defined( LL_SYSTEMINFO_IO_URING )
+        benchmark_offsets offsets( test_, m_size );
+        std::minstd_rand generator( 1 );
+        bool write = test_.pattern == benchmark_pattern::sequential_write;
+
+        // declared before the ring, so the buffers outlive requests that are cancelled by an exception
+        auto buffers = allocate_aligned( static_cast< size_t >( test_.blockSize ) * test_.queueDepth );
+        std::vector< iovec > vectors( test_.queueDepth );
+        std::vector< std::chrono::steady_clock::time_point > starts( test_.queueDepth );
+
+        detail::io_ring ring( test_.queueDepth );
+        if( !ring.is_open() )
+          throw exception( error::invalid_request, "io_uring" );
+
+        // READV / WRITEV are available since linux 5.1, READ / WRITE only since 5.6
+        auto queue = [&]( unsigned slot_ )
+        {
+          vectors[ slot_ ].iov_base = buffers.get() + static_cast< size_t >( slot_ ) * test_.blockSize;
+          vectors[ slot_ ].iov_len = test_.blockSize;
+
+          auto sqe = ring.get_sqe();
+          sqe->opcode = write ? IORING_OP_WRITEV : IORING_OP_READV;
+          sqe->fd = fd();
+          sqe->addr = reinterpret_cast< std::uint64_t >( &vectors[ slot_ ] );
+          sqe->len = 1;
+          sqe->off = offsets.next( generator );
+          sqe->user_data = slot_;
+          starts[ slot_ ] = std::chrono::steady_clock::now();
+        };
+
+        unsigned inFlight = 0;
+        for( ; inFlight < test_.queueDepth; ++inFlight )
+          queue( inFlight );
+
+        while( inFlight > 0 )
+        {
+          auto submitted = ring.submit( 1 );
+          if( ( submitted < 0 ) && ( submitted != -EINTR ) && ( submitted != -EAGAIN ) )
+            throw exception( error::internal, -submitted );
+
+          while( auto cqe = ring.peek() )
+          {
+            auto slot = static_cast< unsigned >( cqe->user_data );
+            auto result = cqe->res;
+            ring.pop();
+            --inFlight;
+
+            auto now = std::chrono::steady_clock::now();
+            if( result != static_cast< int >( test_.blockSize ) )
+              throw exception( error::internal, ( result < 0 ) ? -result : EIO );
+
+            latencies_.push_back( elapsed_nanoseconds( starts[ slot ], now ) );
+            if( now < deadline_ )
+            {
+              queue( slot );
+              ++inFlight;
+            }
+          }
+        }
+#else
+        ( void )test_;
+        ( void )deadline_;
+        ( void )latencies_;
+        throw exception( error::invalid_request, "io_uring" );
+#endif
+      }
+
+      scratch_file m_scratch;
+      std::uint64_t m_size;
+      int m_directFd = -1;
+    };
+
+
+    const unsigned s_canaryBlocks = 64;  // the reads rotate through the blocks
+
+
+    class direct_canary_file : public impl::canary_file
+    {
+    public:
+      direct_canary_file( int fd_, bool direct_, aligned_buffer buffer_ )
+        : m_fd( fd_ ), m_direct( direct_ ), m_buffer( std::move( buffer_ ) )
+      {
+      }
+
+      ~direct_canary_file()
+      {
+        ::close( m_fd );
+      }
+
+      int read() override
+      {
+        auto offset = static_cast< off_t >( m_next++ % s_canaryBlocks ) * s_benchmarkAlignment;
+
+        // without O_DIRECT (e.g. tmpfs before linux 6.6) at least the cached page is dropped
+        if( !m_direct )
+          ::posix_fadvise( m_fd, offset, s_benchmarkAlignment, POSIX_FADV_DONTNEED );
+
+        auto count = ::pread( m_fd, m_buffer.get(), s_benchmarkAlignment, offset );
+        if( count < 0 )
+          return errno;
+
+        return ( count == static_cast< ssize_t >( s_benchmarkAlignment ) ) ? 0 : EIO;
+      }
+
+    private:
+      int m_fd;
+      bool m_direct;
+      aligned_buffer m_buffer;
+      unsigned m_next = 0;
+    };
   }
 
 
-  storage_info get_storage_info( scan_network_storage scan_ )
+  // ---------------------------------------------------------------------------------------------------------
+
+  storage_info get_storage_info( const storage_query& query_ )
   {
     storage_info info;
 
@@ -101,27 +1372,356 @@ namespace storage
       if( mnt.mnt_dir == NULL ) 
         continue;
  
-      std::string fsname = mnt.mnt_fsname;
-      if( fsname.find( "/dev/" ) != 0 )
+      if( !is_volume( mnt.mnt_fsname, mnt.mnt_type, query_.scan ) )
         continue;
 
-      struct statvfs64 fs;
-      if( statvfs64( mnt.mnt_dir, &fs ) != 0 )
-        continue;
+      info.volumes.push_back( storage_info::volume() );
+      create_volume( mnt.mnt_dir, mnt.mnt_fsname, mnt.mnt_type, info.volumes.back() );
+    }
+    endmntent( mtab );
 
-      storage_info::volume volume;
-      volume.path = mnt.mnt_dir;
-      volume.name = mnt_dir_to_volume_name( mnt.mnt_dir );
-      volume.type = fsname_to_volume_type( mnt.mnt_fsname );
-      volume.fileSystem = mnt_type_to_filesystem( mnt.mnt_type );
+    prune_capacities( impl::read_mount_table() );
 
-      volume.totalSizeInBytes = fs.f_blocks * fs.f_frsize;
-      volume.availableSizeInBytes = fs.f_bavail * fs.f_frsize;
-      
-      info.volumes.push_back( volume );
+    // volumes that can't be queried at all are left out
+    auto usable = query_capacities( info.volumes, query_ );
+    size_t count = 0;
+    for( size_t i = 0; i < info.volumes.size(); ++i )
+    {
+      if( !usable[ i ] )
+        continue;
+
+      if( count != i )
+        info.volumes[ count ] = std::move( info.volumes[ i ] );
+      ++count;
     }
+    info.volumes.resize( count );
+
     return info;
   }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  std::vector< filesystem_info > get_filesystems( const storage_query& query_ )
+  {
+    auto mounts = impl::read_mount_table();
+    prune_capacities( mounts );
+
+    // a mount that's listed later hides the earlier ones on the same path
+    std::map< std::string, std::uint64_t > visible;
+    for( const auto& m : mounts )
+      visible[ m.path ] = m.device;
+
+    std::vector< filesystem_info > filesystems;
+    std::map< std::uint64_t, size_t > indices;
+    for( const auto& m : mounts )
+    {
+      if( ( visible[ m.path ] != m.device ) || !is_volume( m.source, m.type, query_.scan ) )
+        continue;
+
+      auto index = indices.find( m.device );
+      if( index != indices.end() )
+      {
+        filesystems[ index->second ].mountPoints.push_back( m.path );
+        continue;
+      }
+
+      indices[ m.device ] = filesystems.size();
+      filesystems.push_back( filesystem_info() );
+
+      auto& f = filesystems.back();
+      f.deviceId = m.device;
+      f.mountPoints.push_back( m.path );
+      create_volume( m.path.c_str(), m.source.c_str(), m.type.c_str(), f.volume );
+    }
+
+    // file systems that can't be queried at all are left out, like in get_storage_info
+    std::vector< storage_info::volume > volumes;
+    volumes.reserve( filesystems.size() );
+    for( const auto& f : filesystems )
+      volumes.push_back( f.volume );
+
+    auto usable = query_capacities( volumes, query_ );
+    size_t count = 0;
+    for( size_t i = 0; i < filesystems.size(); ++i )
+    {
+      if( !usable[ i ] )
+        continue;
+
+      filesystems[ i ].volume = std::move( volumes[ i ] );
+      if( count != i )
+        filesystems[ count ] = std::move( filesystems[ i ] );
+      ++count;
+    }
+    filesystems.resize( count );
+
+    return filesystems;
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  io_capabilities get_io_capabilities( const fs::path& directory_ )
+  {
+    struct stat64 directory;
+    if( stat64( directory_.string().c_str(), &directory ) != 0 )
+      throw exception( error::invalid_parameter, directory_.string() );
+
+    // the mount of the directory is the one of its file system with the longest path that contains it,
+    // this includes file systems that get_storage_info doesn't list, e.g. tmpfs or overlay
+    auto path = fs::canonical( directory_ ).string();
+    auto contains = [&path]( const std::string& mountPoint_ )
+    {
+      return ( path.compare( 0, mountPoint_.size(), mountPoint_ ) == 0 ) 
+        && ( ( path.size() == mountPoint_.size() ) || ( mountPoint_.back() == '/' ) 
+          || ( path[ mountPoint_.size() ] == '/' ) );
+    };
+
+    auto mounts = impl::read_mount_table();
+    const impl::mount_entry* mount = nullptr;
+    for( const auto& m : mounts )
+    {
+      bool longer = !mount || ( m.path.size() >= mount->path.size() );
+      if( ( m.device == directory.st_dev ) && contains( m.path ) && longer )
+        mount = &m;
+    }
+
+    io_capabilities capabilities;
+    if( mount )
+    {
+      std::vector< storage_info::volume > volumes( 1 );
+      create_volume( mount->path.c_str(), mount->source.c_str(), mount->type.c_str(), volumes.front() );
+      if( query_capacities( volumes, storage_query() ).front() )
+        capabilities.volume = volumes.front();
+    }
+
+    // the capabilities are the same for the whole file system, including its bind mounts; anonymous device 
+    // numbers (tmpfs, overlay, btrfs) get reused after an unmount, the type and source tell those apart
+    using probe_key = std::tuple< std::uint64_t, std::string, std::string >;
+    auto key = mount ? probe_key( mount->device, mount->type, mount->source ) 
+                     : probe_key( directory.st_dev, std::string(), std::string() );
+
+    static std::mutex s_mutex;
+    static std::map< probe_key, io_capabilities > s_capabilities;  // without the volume
+    {
+      std::lock_guard< std::mutex > lock( s_mutex );
+      auto cached = s_capabilities.find( key );
+      if( cached != s_capabilities.end() )
+      {
+        auto volume = std::move( capabilities.volume );
+        capabilities = cached->second;
+        capabilities.volume = std::move( volume );
+        return capabilities;
+      }
+    }
+
+    scratch_file file( directory_.string() );
+    if( file.fd() < 0 )
+      throw exception( error::invalid_parameter, directory_.string() );
+
+    struct stat64 attributes;
+    if( fstat64( file.fd(), &attributes ) == 0 )
+      capabilities.optimalBlockSize = static_cast< unsigned >( attributes.st_blksize );
+
+    probe_direct_io( file, capabilities );
+    probe_allocation( file, capabilities );
+    probe_copies( file, capabilities );
+#if defined( LL_SYSTEMINFO_IO_URING )
+    capabilities.ioUring = probe_io_uring( file.path() );
+#endif
+
+    auto probed = capabilities;
+    probed.volume = storage_info::volume();
+
+    // the file systems that are no longer mounted are dropped when another one is added
+    std::set< probe_key > mounted;
+    for( const auto& m : mounts )
+      mounted.insert( probe_key( m.device, m.type, m.source ) );
+
+    std::lock_guard< std::mutex > lock( s_mutex );
+    for( auto it = s_capabilities.begin(); it != s_capabilities.end(); )
+    {
+      if( mounted.count( it->first ) == 0 )
+        it = s_capabilities.erase( it );
+      else
+        ++it;
+    }
+
+    s_capabilities[ key ] = probed;
+    return capabilities;
+  }
+
+
+  namespace impl
+  {
+    std::unique_ptr< io_reader > create_io_reader()
+    {
+      return std::unique_ptr< io_reader >( new diskstats_reader() );
+    }
+
+
+    std::unique_ptr< mount_reader > create_mount_reader( scan_network_storage scan_ )
+    {
+      return std::unique_ptr< mount_reader >( new mountinfo_reader( scan_ ) );
+    }
+
+
+    std::unique_ptr< benchmark_file > create_benchmark_file( const fs::path& directory_, std::uint64_t size_ )
+    {
+      return std::unique_ptr< benchmark_file >( new scratch_benchmark_file( directory_.string(), size_ ) );
+    }
+
+
+    std::vector< bool > update_capacities( 
+      std::vector< storage_info::volume >& volumes_, 
+      const storage_query& query_ 
+    )
+    {
+      return query_capacities( volumes_, query_ );
+    }
+
+
+    std::vector< mount_entry > read_mount_table()
+    {
+      std::vector< mount_entry > entries;
+
+      detail::proc_file file( "/proc/self/mountinfo" );
+      if( !file.read() )
+        return entries;
+
+      // e.g. "36 35 98:0 /mnt1 /mnt2 rw,noatime master:1 - ext3 /dev/root rw,errors=continue"
+      const char* p = file.data();
+      const char* end = file.end();
+      while( p != end )
+      {
+        const char* line = p;
+        detail::skip_line( p, end );
+        const char* lineEnd = ( ( p != line ) && ( p[ -1 ] == '\n' ) ) ? p - 1 : p;
+
+        const char* q = line;
+        auto next_field = [&q, lineEnd]( const char*& begin_ )
+        {
+          while( ( q != lineEnd ) && ( *q == ' ' ) )
+            ++q;
+          begin_ = q;
+          while( ( q != lineEnd ) && ( *q != ' ' ) )
+            ++q;
+          return q;
+        };
+
+        const char* begin = nullptr;
+        next_field( begin );
+        next_field( begin );
+
+        mount_entry entry;
+
+        next_field( begin );
+        auto major = detail::parse_uint( begin, q );
+        if( ( begin != q ) && ( *begin == ':' ) )
+          ++begin;
+        auto minor = detail::parse_uint( begin, q );
+        entry.device = static_cast< std::uint64_t >( 
+          makedev( static_cast< unsigned >( major ), static_cast< unsigned >( minor ) ) 
+        );
+
+        next_field( begin );
+        auto pathEnd = next_field( begin );
+        entry.path = unescape_mount_point( begin, pathEnd );
+
+        // the optional fields are terminated by a single hyphen
+        do
+        {
+          next_field( begin );
+        } while( ( begin != lineEnd ) && !( ( q - begin == 1 ) && ( *begin == '-' ) ) );
+
+        auto typeEnd = next_field( begin );
+        entry.type.assign( begin, typeEnd );
+        auto sourceEnd = next_field( begin );
+        entry.source = unescape_mount_point( begin, sourceEnd );
+
+        if( entry.type == "overlay" )
+        {
+          auto optionsEnd = next_field( begin );
+          std::string options( begin, optionsEnd );
+          auto upper = options.find( "upperdir=" );
+          if( upper != std::string::npos )
+          {
+            auto first = options.data() + upper + 9;
+            auto last = options.data() + std::min( options.find( ',', upper ), options.size() );
+            entry.upperDirectory = unescape_mount_point( first, last );
+          }
+        }
+
+        if( !entry.path.empty() )
+          entries.push_back( std::move( entry ) );
+      }
+
+      return entries;
+    }
+
+
+    std::unique_ptr< canary_file > open_canary_file( const fs::path& path_, bool create_, int& error_ )
+    {
+      error_ = 0;
+      auto path = path_.string();
+      const size_t size = s_canaryBlocks * s_benchmarkAlignment;
+
+      // written once through the page cache and synced, so the direct reads hit the device
+      struct stat64 attributes;
+      auto exists = stat64( path.c_str(), &attributes ) == 0;
+      if( !exists || ( attributes.st_size < static_cast< off_t >( size ) ) )
+      {
+        if( !create_ )
+        {
+          error_ = exists ? EINVAL : errno;
+          return nullptr;
+        }
+
+        int fd = ::open( path.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644 );
+        if( fd < 0 )
+        {
+          error_ = errno;
+          return nullptr;
+        }
+
+        std::vector< char > content( size, 0x5a );
+        auto written = ::pwrite( fd, content.data(), size, 0 ) == static_cast< ssize_t >( size );
+        if( !written || ( ::fsync( fd ) != 0 ) )
+          error_ = errno ? errno : EIO;
+
+        ::close( fd );
+        if( error_ != 0 )
+          return nullptr;
+      }
+
+      bool direct = true;
+      int fd = ::open( path.c_str(), O_RDONLY | O_DIRECT | O_CLOEXEC );
+      if( ( fd < 0 ) && ( errno == EINVAL ) )
+      {
+        direct = false;
+        fd = ::open( path.c_str(), O_RDONLY | O_CLOEXEC );
+      }
+
+      if( fd < 0 )
+      {
+        error_ = errno;
+        return nullptr;
+      }
+
+      void* buffer = nullptr;
+      if( ::posix_memalign( &buffer, s_benchmarkAlignment, s_benchmarkAlignment ) != 0 )
+      {
+        ::close( fd );
+        error_ = ENOMEM;
+        return nullptr;
+      }
+
+      return std::unique_ptr< canary_file >( 
+        new direct_canary_file( fd, direct, aligned_buffer( static_cast< char* >( buffer ), &std::free ) ) 
+      );
+    }
+
+  }  // namespace impl
   
   
 } // namespace storage
@@ -17,11 +17,14 @@
 *************************************************************************************************************/
 
 #include "systeminfo/storage.h"
+#include "systeminfo/exception.h"
+#include "storage_impl.h"
 
 #import <Cocoa/Cocoa.h>
 
 #include <sys/mount.h>
 
+#include <cerrno>
 #include <string>
 
 #include <boost/filesystem/convenience.hpp>
@@ -37,7 +40,7 @@ namespace systeminfo
 {
 namespace storage
 {
-  storage_info get_storage_info( scan_network_storage )
+  storage_info get_storage_info( const storage_query& )
   {
     storage_info info;
     
@@ -101,6 +104,7 @@ namespace storage
       case filesystem::smb:
       case filesystem::afp:
       case filesystem::nfs:
+      case filesystem::nfs4:
       case filesystem::autofs:
         volume.type = storage_type::network;
         break;
@@ -108,7 +112,7 @@ namespace storage
         if ([isRemovable boolValue])
           volume.type = storage_type::removable;
         else
-          volume.type = storage_type::harddisk;
+          volume.type = storage_type::harddisk;  //! \todo solid_state (kIOPropertyMediumTypeSolidStateKey)
         break;
       }
     
@@ -164,6 +168,121 @@ namespace storage
     return info;
   }
 
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  io_capabilities get_io_capabilities( const fs::path& directory_ )
+  {
+    io_capabilities capabilities;
+    auto info = get_storage_info();
+    if( auto volume = impl::find_owning_volume( info, fs::canonical( directory_ ) ) )
+      capabilities.volume = *volume;
+
+    //! \todo F_NOCACHE, F_PREALLOCATE, F_PUNCHHOLE and clonefile()
+    return capabilities;
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  std::vector< filesystem_info > get_filesystems( const storage_query& query_ )
+  {
+    //! \todo the firmlinks of the system and data volumes
+    auto info = get_storage_info( query_ );
+
+    std::vector< filesystem_info > filesystems;
+    for( auto& v : info.volumes )
+    {
+      filesystem_info f;
+      f.mountPoints.push_back( v.path );
+      f.volume = std::move( v );
+      filesystems.push_back( std::move( f ) );
+    }
+    return filesystems;
+  }
+
+
+  namespace impl
+  {
+    class block_storage_reader : public io_reader
+    {
+    public:
+      void read( std::vector< device_io >& devices_ ) override
+      {
+        //! \todo the "Statistics" property of the IOBlockStorageDriver services
+        devices_.clear();
+      }
+    };
+
+
+    std::unique_ptr< io_reader > create_io_reader()
+    {
+      return std::unique_ptr< io_reader >( new block_storage_reader() );
+    }
+
+
+    std::unique_ptr< mount_reader > create_mount_reader( scan_network_storage )
+    {
+      //! \todo DiskArbitration (DARegisterDiskAppearedCallback and friends)
+      throw exception( error::invalid_request, "mount watcher" );
+    }
+
+
+    std::unique_ptr< benchmark_file > create_benchmark_file( const fs::path&, std::uint64_t )
+    {
+      //! \todo F_NOCACHE with pread / pwrite
+      throw exception( error::invalid_request, "disk benchmark" );
+    }
+
+
+    std::vector< bool > update_capacities( 
+      std::vector< storage_info::volume >& volumes_, 
+      const storage_query& 
+    )
+    {
+      //! \todo the timeout, statfs blocks on an unresponsive network volume
+      std::vector< bool > usable( volumes_.size(), false );
+      for( size_t i = 0; i < volumes_.size(); ++i )
+      {
+        auto& v = volumes_[ i ];
+        struct statfs stat;
+        usable[ i ] = ::statfs( v.path.c_str(), &stat ) == 0;
+        if( usable[ i ] )
+        {
+          v.totalSizeInBytes = static_cast< std::uint64_t >( stat.f_blocks ) * stat.f_bsize;
+          v.availableSizeInBytes = static_cast< std::uint64_t >( stat.f_bavail ) * stat.f_bsize;
+        }
+        v.capacity = usable[ i ] ? capacity_state::current : capacity_state::stale;
+      }
+      return usable;
+    }
+
+
+    std::vector< mount_entry > read_mount_table()
+    {
+      //! \todo getmntinfo() with f_fsid
+      std::vector< mount_entry > entries;
+      auto info = get_storage_info();
+      for( size_t i = 0; i < info.volumes.size(); ++i )
+      {
+        mount_entry entry;
+        entry.path = info.volumes[ i ].path.string();
+        entry.device = i + 1;
+        entries.push_back( entry );
+      }
+      return entries;
+    }
+
+
+    std::unique_ptr< canary_file > open_canary_file( const fs::path&, bool, int& error_ )
+    {
+      //! \todo F_NOCACHE reads
+      error_ = ENOSYS;
+      return nullptr;
+    }
+
+  }  // namespace impl
+
 } // namespace storage
 } // namespace systeminfo
 } // namespace ll
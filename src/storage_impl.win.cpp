@@ -17,11 +17,13 @@
 *************************************************************************************************************/
 
 #include "systeminfo/storage.h"
+#include "storage_impl.h"
 
 #include "systeminfo/exception.h"
 
 #include <base/environment.h>
 
+#include <cerrno>
 #include <string>
 #include <array>
 #include <algorithm>
@@ -37,8 +39,9 @@ namespace storage
 {
   // ---------------------------------------------------------------------------------------------------------
 
-  storage_info get_storage_info( scan_network_storage scan_ )
+  storage_info get_storage_info( const storage_query& query_ )
   {
+    //! \todo query_.timeout, GetDiskFreeSpaceEx blocks on an unresponsive network drive
     auto buffersize = ::GetLogicalDriveStringsW( 0, nullptr );
     if( buffersize == 0 )
       throw exception( error::internal );
@@ -66,6 +69,8 @@ namespace storage
       {
         case DRIVE_RAMDISK:
         case DRIVE_FIXED:
+          //! \todo solid_state and storage_info::block_device via IOCTL_STORAGE_QUERY_PROPERTY
+          //! (StorageDeviceSeekPenaltyProperty, StorageAccessAlignmentProperty)
           v.type = storage_type::harddisk;
           break;
         case DRIVE_CDROM:
@@ -74,7 +79,7 @@ namespace storage
           break;
         case DRIVE_REMOTE:
           v.type = storage_type::network;
-          if( scan_ == scan_network_storage::exclude )
+          if( query_.scan == scan_network_storage::exclude )
             continue;
           break;
         default:
@@ -121,7 +126,121 @@ namespace storage
   }
 
 
-  
+  // ---------------------------------------------------------------------------------------------------------
+
+  io_capabilities get_io_capabilities( const fs::path& directory_ )
+  {
+    io_capabilities capabilities;
+    auto info = get_storage_info();
+    if( auto volume = impl::find_owning_volume( info, fs::canonical( directory_ ) ) )
+      capabilities.volume = *volume;
+
+    //! \todo FILE_FLAG_NO_BUFFERING, FSCTL_DUPLICATE_EXTENTS_TO_FILE, FSCTL_SET_SPARSE ...
+    return capabilities;
+  }
+
+
+  // ---------------------------------------------------------------------------------------------------------
+
+  std::vector< filesystem_info > get_filesystems( const storage_query& query_ )
+  {
+    //! \todo GetVolumePathNamesForVolumeName for the folders a volume is mounted to
+    auto info = get_storage_info( query_ );
+
+    std::vector< filesystem_info > filesystems;
+    for( auto& v : info.volumes )
+    {
+      filesystem_info f;
+      f.mountPoints.push_back( v.path );
+      f.volume = std::move( v );
+      filesystems.push_back( std::move( f ) );
+    }
+    return filesystems;
+  }
+
+
+  namespace impl
+  {
+    class disk_performance_reader : public io_reader
+    {
+    public:
+      void read( std::vector< device_io >& devices_ ) override
+      {
+        //! \todo IOCTL_DISK_PERFORMANCE on the physical drives
+        devices_.clear();
+      }
+    };
+
+
+    std::unique_ptr< io_reader > create_io_reader()
+    {
+      return std::unique_ptr< io_reader >( new disk_performance_reader() );
+    }
+
+
+    std::unique_ptr< mount_reader > create_mount_reader( scan_network_storage )
+    {
+      //! \todo RegisterDeviceNotification for DBT_DEVICEARRIVAL / DBT_DEVICEREMOVECOMPLETE
+      throw exception( error::invalid_request, "mount watcher" );
+    }
+
+
+    std::unique_ptr< benchmark_file > create_benchmark_file( const fs::path&, std::uint64_t )
+    {
+      //! \todo FILE_FLAG_NO_BUFFERING with overlapped i/o on an i/o completion port
+      throw exception( error::invalid_request, "disk benchmark" );
+    }
+
+
+    std::vector< bool > update_capacities( 
+      std::vector< storage_info::volume >& volumes_, 
+      const storage_query& 
+    )
+    {
+      //! \todo the timeout, GetDiskFreeSpaceEx blocks on an unresponsive network drive
+      std::vector< bool > usable( volumes_.size(), false );
+      for( size_t i = 0; i < volumes_.size(); ++i )
+      {
+        auto& v = volumes_[ i ];
+        ULARGE_INTEGER bytesTotal = ULARGE_INTEGER();
+        ULARGE_INTEGER bytesAvailable = ULARGE_INTEGER();
+        auto path = v.path.string();
+        usable[ i ] = ::GetDiskFreeSpaceEx( path.c_str(), &bytesAvailable, &bytesTotal, nullptr ) != 0;
+        if( usable[ i ] )
+        {
+          v.totalSizeInBytes = static_cast< std::uint64_t >( bytesTotal.QuadPart );
+          v.availableSizeInBytes = static_cast< std::uint64_t >( bytesAvailable.QuadPart );
+        }
+        v.capacity = usable[ i ] ? capacity_state::current : capacity_state::stale;
+      }
+      return usable;
+    }
+
+
+    std::vector< mount_entry > read_mount_table()
+    {
+      //! \todo GetVolumePathNamesForVolumeName for the folders a volume is mounted to
+      std::vector< mount_entry > entries;
+      auto info = get_storage_info();
+      for( size_t i = 0; i < info.volumes.size(); ++i )
+      {
+        mount_entry entry;
+        entry.path = info.volumes[ i ].path.string();
+        entry.device = i + 1;
+        entries.push_back( entry );
+      }
+      return entries;
+    }
+
+
+    std::unique_ptr< canary_file > open_canary_file( const fs::path&, bool, int& error_ )
+    {
+      //! \todo FILE_FLAG_NO_BUFFERING reads
+      error_ = ENOSYS;
+      return nullptr;
+    }
+
+  }  // namespace impl
 
 } // namespace storage
 } // namespace systeminfo
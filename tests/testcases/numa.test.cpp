@@ -0,0 +1,98 @@
+/*************************************************************************************************************
+
+ Limelight Framework - SystemInfo Utils
+
+
+ Copyright 2016 mvd
+
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in
+ compliance with the License. You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software distributed under the License is
+ distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and limitations under the License.
+
+*************************************************************************************************************/
+
+#include "platform_impl.h"
+
+#include <catch.hpp>
+
+#include <string>
+#include <vector>
+
+
+#if defined( __linux__ )
+
+using namespace ll::systeminfo::platform;
+
+namespace
+{
+  //! two packages with one node each, the cpus are numbered alternately across the packages
+  const std::string s_twoNodes = std::string( LL_SYSTEMINFO_TEST_DATA ) + "/sysfs/two_nodes";
+}
+
+
+TEST_CASE( "the numa topology is read from a two node sysfs tree", "[numa]" )
+{
+  auto info = impl::get_numa_info( s_twoNodes );
+  REQUIRE( info.nodes.size() == 2 );
+
+  SECTION( "cpu lists" )
+  {
+    CHECK( info.nodes[ 0 ].id == 0 );
+    CHECK( info.nodes[ 0 ].logicalCores == std::vector< unsigned >( { 0, 2 } ) );
+    CHECK( info.nodes[ 0 ].processorPacks == std::vector< unsigned >( { 0 } ) );
+
+    CHECK( info.nodes[ 1 ].id == 1 );
+    CHECK( info.nodes[ 1 ].logicalCores == std::vector< unsigned >( { 1, 3 } ) );
+    CHECK( info.nodes[ 1 ].processorPacks == std::vector< unsigned >( { 1 } ) );
+  }
+
+  SECTION( "memory" )
+  {
+    CHECK( info.nodes[ 0 ].totalMemoryInBytes == 16777216ull * 1024 );
+    CHECK( info.nodes[ 0 ].freeMemoryInBytes == 8388608ull * 1024 );
+    CHECK( info.nodes[ 1 ].totalMemoryInBytes == 33554432ull * 1024 );
+    CHECK( info.nodes[ 1 ].freeMemoryInBytes == 4194304ull * 1024 );
+  }
+
+  SECTION( "distance matrix" )
+  {
+    CHECK( info.nodes[ 0 ].distances == std::vector< unsigned >( { 10, 21 } ) );
+    CHECK( info.nodes[ 1 ].distances == std::vector< unsigned >( { 21, 10 } ) );
+  }
+}
+
+
+TEST_CASE( "the logical cores link to their numa node", "[numa]" )
+{
+  auto info = impl::get_cpu_topology( s_twoNodes + "/cpu" );
+  REQUIRE( info.processorPacks.size() == 2 );
+
+  std::vector< unsigned > nodes( 4, 99 );
+  for( const auto& pack : info.processorPacks )
+  {
+    for( const auto& core : pack.physicalCores )
+    {
+      for( const auto& logical : core.logicalCores )
+      {
+        REQUIRE( logical.id < nodes.size() );
+        nodes[ logical.id ] = logical.numaNode;
+      }
+    }
+  }
+
+  CHECK( nodes == std::vector< unsigned >( { 0, 1, 0, 1 } ) );
+
+  // and back, every core a node lists is linked to that node
+  for( const auto& node : impl::get_numa_info( s_twoNodes ).nodes )
+  {
+    for( auto id : node.logicalCores )
+      CHECK( nodes[ id ] == node.id );
+  }
+}
+
+#endif